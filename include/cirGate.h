@@ -0,0 +1 @@
+../src/cir/cirGate.h
\ No newline at end of file
@@ -0,0 +1 @@
+../src/util/myArena.h
\ No newline at end of file
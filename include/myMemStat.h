@@ -0,0 +1 @@
+../src/util/myMemStat.h
\ No newline at end of file
@@ -0,0 +1 @@
+../src/util/myProfile.h
\ No newline at end of file
@@ -0,0 +1 @@
+../src/util/myTrace.h
\ No newline at end of file
@@ -0,0 +1,5 @@
+bench.o: bench.cpp ../../include/cirGate.h ../../include/cirDef.h \
+ ../../include/cirMgr.h ../../include/myArena.h ../../include/cirMgr.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfile.h ../../include/myTrace.h \
+ ../../include/myMemStat.h
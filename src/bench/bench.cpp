@@ -0,0 +1,278 @@
+/****************************************************************************
+  FileName     [ bench.cpp ]
+  PackageName  [ bench ]
+  Synopsis     [ Define main() of the cir benchmark harness ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "cirGate.h"
+#include "cirMgr.h"
+#include "util.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Benchmark settings
+//----------------------------------------------------------------------
+// Every operation runs WARMUP times untimed, then REPEAT times timed, on
+// the circuit of every file. reportFanin is the fanin report of every PO
+// down to FANIN_LEVEL levels.
+enum BenchDefault
+{
+   BENCH_WARMUP      = 2,
+   BENCH_REPEAT      = 10,
+   BENCH_FANIN_LEVEL = 16
+};
+
+static const char* benchDirs[] = { "tests.fraig", "tests.fraig/ISCAS85" };
+
+// Swallows everything, so that printing is timed without the terminal
+class NullBuf : public streambuf
+{
+protected:
+   int overflow(int c) { return c; }
+   streamsize xsputn(const char*, streamsize n) { return n; }
+};
+
+typedef chrono::steady_clock BenchClock;
+
+//----------------------------------------------------------------------
+//    Operations under test
+//----------------------------------------------------------------------
+// Each runs one operation on mgr; readCircuit replaces mgr with a newly
+// read circuit of file. Only the operation itself is timed.
+typedef bool (*BenchOp)(CirMgr*& mgr, const string& file, ostream& os,
+                        double& sec);
+
+static double
+since(const BenchClock::time_point& t)
+{
+   return chrono::duration<double>(BenchClock::now() - t).count();
+}
+
+static bool
+benchRead(CirMgr*& mgr, const string& file, ostream&, double& sec)
+{
+   delete mgr; mgr = 0;
+   BenchClock::time_point t = BenchClock::now();
+   CirMgr* m = new CirMgr;
+   bool ok = m->readCircuit(file);
+   sec = since(t);
+   if (!ok) { delete m; return false; }
+   mgr = m;
+   return true;
+}
+
+static bool
+benchNetlist(CirMgr*& mgr, const string&, ostream& os, double& sec)
+{
+   // the DFS order is cached by the manager; every run rebuilds it like
+   // the first CIRPrint -Netlist after a change does
+   mgr->invalidateDfsList();
+   BenchClock::time_point t = BenchClock::now();
+   mgr->printNetlist(os);
+   sec = since(t);
+   return true;
+}
+
+static bool
+benchWrite(CirMgr*& mgr, const string&, ostream& os, double& sec)
+{
+   mgr->invalidateDfsList();
+   BenchClock::time_point t = BenchClock::now();
+   mgr->writeAag(os);
+   sec = since(t);
+   return true;
+}
+
+static bool
+benchFloat(CirMgr*& mgr, const string&, ostream&, double& sec)
+{
+   BenchClock::time_point t = BenchClock::now();
+   mgr->printFloatGates();
+   sec = since(t);
+   return true;
+}
+
+static bool
+benchFanin(CirMgr*& mgr, const string&, ostream& os, double& sec)
+{
+   const CirMgr::ParsedCir& cir = mgr->Circuit;
+   BenchClock::time_point t = BenchClock::now();
+   for (size_t id = cir.maxid + 1; id < cir.size(); ++id)
+      mgr->getGate(id).reportFanin(BENCH_FANIN_LEVEL, id, os);
+   sec = since(t);
+   return true;
+}
+
+struct BenchEntry
+{
+   const char*   _name;
+   BenchOp       _op;
+};
+
+// readCircuit must come first: the others run on the circuit it read
+static const BenchEntry benchOps[] = {
+   { "readCircuit",     benchRead },
+   { "printNetlist",    benchNetlist },
+   { "writeAag",        benchWrite },
+   { "printFloatGates", benchFloat },
+   { "reportFanin",     benchFanin }
+};
+
+//----------------------------------------------------------------------
+//    main()
+//----------------------------------------------------------------------
+static void
+usage()
+{
+   cout << "Usage: cirBench [-Warmup (int num)] [-Repeat (int num)]" << endl
+        << "                [-Output (string csvFile)] [aagFile...]" << endl
+        << "  Without aagFile, every .aag file in tests.fraig and" << endl
+        << "  tests.fraig/ISCAS85 is used." << endl;
+}
+
+static void
+myexit()
+{
+   usage();
+   exit(-1);
+}
+
+// the count following option argv[i]; i is moved onto it
+static void
+getCount(int argc, char** argv, int& i, int& num)
+{
+   if (++i == argc || !myStr2Int(argv[i], num) || num < 0) {
+      cerr << "Error: illegal number for \"" << argv[i - 1] << "\"!!\n";
+      myexit();
+   }
+}
+
+static bool
+hasSuffix(const string& s, const string& suffix)
+{
+   return s.size() >= suffix.size() &&
+          s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// time in ms of the p-th fraction of the sorted times, nearest rank
+static double
+percentile(const vector<double>& sorted, double p)
+{
+   size_t k = size_t(p * sorted.size() + 0.999999);
+   return sorted[k ? k - 1 : 0] * 1000;
+}
+
+static double
+median(const vector<double>& sorted)
+{
+   size_t n = sorted.size();
+   return (sorted[(n - 1) / 2] + sorted[n / 2]) / 2 * 1000;
+}
+
+int
+main(int argc, char** argv)
+{
+   myUsage.reset();
+
+   int warmup = BENCH_WARMUP, repeat = BENCH_REPEAT;
+   string csvFile;
+   vector<string> files;
+   for (int i = 1; i < argc; ++i) {
+      if (myStrNCmp("-Warmup", argv[i], 2) == 0)
+         getCount(argc, argv, i, warmup);
+      else if (myStrNCmp("-Repeat", argv[i], 2) == 0)
+         getCount(argc, argv, i, repeat);
+      else if (myStrNCmp("-Output", argv[i], 2) == 0) {
+         if (++i == argc) {
+            cerr << "Error: missing file name for \"-Output\"!!\n";
+            myexit();
+         }
+         csvFile = argv[i];
+      }
+      else if (argv[i][0] == '-') {
+         cerr << "Error: unknown argument \"" << argv[i] << "\"!!\n";
+         myexit();
+      }
+      else files.push_back(argv[i]);
+   }
+   if (repeat == 0) {
+      cerr << "Error: at least one timed run is needed!!\n";
+      myexit();
+   }
+   if (files.empty()) {
+      for (size_t d = 0; d < sizeof(benchDirs) / sizeof(benchDirs[0]); ++d) {
+         vector<string> names;
+         if (listDir(names, "", benchDirs[d]) != 0) continue;
+         for (size_t i = 0, n = names.size(); i < n; ++i)
+            if (hasSuffix(names[i], ".aag"))
+               files.push_back(string(benchDirs[d]) + "/" + names[i]);
+      }
+      if (files.empty()) {
+         cerr << "Error: no .aag file found; run cirBench from the top "
+              << "directory or give the files!!\n";
+         myexit();
+      }
+   }
+
+   ofstream csvf;
+   if (!csvFile.empty()) {
+      csvf.open(csvFile.c_str());
+      if (!csvf) {
+         cerr << "Error: cannot open file \"" << csvFile << "\"!!\n";
+         myexit();
+      }
+   }
+   ostream& csv = csvFile.empty() ? cout : csvf;
+   csv << "file,op,gates,runs,median_ms,p95_ms,gates_per_sec,peak_rss_mb"
+       << endl;
+
+   NullBuf nullBuf;
+   ostream nullStream(&nullBuf);
+   const size_t nOps = sizeof(benchOps) / sizeof(benchOps[0]);
+   CirMgr* mgr = 0;
+   vector<double> times;
+   for (size_t f = 0, nf = files.size(); f < nf; ++f) {
+      for (size_t k = 0; k < nOps; ++k) {
+         times.clear();
+         bool ok = true;
+         // the printers go to cout; keep them off the terminal and csv
+         streambuf* coutBuf = cout.rdbuf(&nullBuf);
+         for (int r = 0; ok && r < warmup + repeat; ++r) {
+            double sec;
+            ok = benchOps[k]._op(mgr, files[f], nullStream, sec);
+            if (r >= warmup) times.push_back(sec);
+         }
+         cout.rdbuf(coutBuf);
+         if (!ok) {
+            cerr << "Error: cannot read \"" << files[f] << "\"; skipped"
+                 << endl;
+            break;
+         }
+         sort(times.begin(), times.end());
+         const CirMgr::ParsedCir& cir = mgr->Circuit;
+         size_t gates = cir.inputs + cir.outputs + cir.ands;
+         double med = median(times);
+         csv << files[f] << ',' << benchOps[k]._name << ',' << gates << ','
+             << times.size() << ',' << fixed << setprecision(3) << med
+             << ',' << percentile(times, 0.95) << ',' << setprecision(0)
+             << (med > 0 ? gates / med * 1000 : 0.0) << ','
+             << setprecision(1) << myUsage.getPeakMem() << endl;
+         csv.unsetf(ios::floatfield);
+      }
+   }
+   delete mgr;
+
+   return 0;
+}
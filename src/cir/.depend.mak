@@ -1,7 +1,31 @@
-cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h cirGate.h cirCmd.h \
- ../../include/cmdParser.h ../../include/cmdCharDef.h \
- ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
-cirGate.o: cirGate.cpp cirGate.h cirDef.h cirMgr.h ../../include/util.h \
- ../../include/rnGen.h ../../include/myUsage.h
-cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h cirGate.h ../../include/util.h \
- ../../include/rnGen.h ../../include/myUsage.h
+cirCmd.o: cirCmd.cpp cirMgr.h cirDef.h ../../include/myArena.h cirGate.h \
+ cirCmd.h ../../include/cmdParser.h ../../include/cmdCharDef.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfile.h ../../include/myTrace.h \
+ ../../include/myMemStat.h
+cirFraig.o: cirFraig.cpp cirGate.h cirDef.h cirMgr.h \
+ ../../include/myArena.h ../../include/myThreadPool.h ../../include/sat.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfile.h ../../include/myTrace.h \
+ ../../include/myMemStat.h
+cirGate.o: cirGate.cpp cirGate.h cirDef.h cirMgr.h \
+ ../../include/myArena.h ../../include/myOutBuf.h ../../include/util.h \
+ ../../include/rnGen.h ../../include/myUsage.h ../../include/myProfile.h \
+ ../../include/myTrace.h ../../include/myMemStat.h
+cirGen.o: cirGen.cpp cirMgr.h cirDef.h ../../include/myArena.h \
+ ../../include/myOutBuf.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h ../../include/myProfile.h \
+ ../../include/myTrace.h ../../include/myMemStat.h
+cirMgr.o: cirMgr.cpp cirMgr.h cirDef.h ../../include/myArena.h cirGate.h \
+ ../../include/myOutBuf.h ../../include/myThreadPool.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfile.h ../../include/myTrace.h \
+ ../../include/myMemStat.h
+cirOpt.o: cirOpt.cpp cirGate.h cirDef.h cirMgr.h ../../include/myArena.h \
+ ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h \
+ ../../include/myProfile.h ../../include/myTrace.h \
+ ../../include/myMemStat.h
+cirSim.o: cirSim.cpp cirGate.h cirDef.h cirMgr.h ../../include/myArena.h \
+ ../../include/myThreadPool.h ../../include/util.h ../../include/rnGen.h \
+ ../../include/myUsage.h ../../include/myProfile.h \
+ ../../include/myTrace.h ../../include/myMemStat.h
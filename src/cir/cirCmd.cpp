@@ -9,6 +9,7 @@
 #include <cassert>
 #include <iostream>
 #include <iomanip>
+#include <thread>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "cirCmd.h"
@@ -18,13 +19,49 @@ using namespace std;
 
 extern CirMgr* cirMgr;
 
+// Runs cmd and records its time and memory in myProfile under name
+class CirProfiledCmd : public CmdExec
+{
+public:
+   CirProfiledCmd(const string& name, CmdExec* cmd)
+      : _name(name), _cmd(cmd) {}
+   ~CirProfiledCmd() { delete _cmd; }
+
+   CmdExecStatus exec(const string& option) {
+      TRACE_SPAN(_name.c_str());
+      MyProfile::Stamp before = MyProfile::now();
+      CmdExecStatus status = _cmd->exec(option);
+      myProfile.record(_name, option, before, MyProfile::now());
+      return status;
+   }
+   void usage(ostream& os) const { _cmd->usage(os); }
+   void help() const { _cmd->help(); }
+
+private:
+   string     _name;
+   CmdExec*   _cmd;
+};
+
+static bool
+regProfiledCmd(const string& name, unsigned nCmp, CmdExec* cmd)
+{
+   return cmdMgr->regCmd(name, nCmp, new CirProfiledCmd(name, cmd));
+}
+
 bool
 initCirCmd()
 {
-   if (!(cmdMgr->regCmd("CIRRead", 4, new CirReadCmd) &&
-         cmdMgr->regCmd("CIRPrint", 4, new CirPrintCmd) &&
-         cmdMgr->regCmd("CIRGate", 4, new CirGateCmd) &&
-         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd)
+   if (!(regProfiledCmd("CIRRead", 4, new CirReadCmd) &&
+         regProfiledCmd("CIRPrint", 4, new CirPrintCmd) &&
+         regProfiledCmd("CIRGate", 4, new CirGateCmd) &&
+         regProfiledCmd("CIRWrite", 4, new CirWriteCmd) &&
+         regProfiledCmd("CIRSim", 4, new CirSimCmd) &&
+         regProfiledCmd("CIRSWeep", 5, new CirSweepCmd) &&
+         regProfiledCmd("CIROPTimize", 6, new CirOptCmd) &&
+         regProfiledCmd("CIRSTRash", 6, new CirStrashCmd) &&
+         regProfiledCmd("CIRFraig", 4, new CirFraigCmd) &&
+         regProfiledCmd("CIRGENerate", 6, new CirGenCmd) &&
+         cmdMgr->regCmd("CIRPROFile", 7, new CirProfileCmd)
       )) {
       cerr << "Registering \"cir\" commands fails... exiting" << endl;
       return false;
@@ -43,8 +80,26 @@ enum CirCmdState
 
 static CirCmdState curCmd = CIRINIT;
 
+// The number of a -Threads option: at least 1, and at most the threads
+// the hardware runs at once. A larger number is cut down with a note, so
+// a typo cannot exhaust the system's threads or memory.
+static bool
+str2Threads(const string& str, int& nThreads)
+{
+   if (!myStr2Int(str, nThreads) || nThreads < 1) return false;
+   unsigned maxThreads = thread::hardware_concurrency();
+   if (maxThreads == 0) maxThreads = 1;  // not known
+   if (unsigned(nThreads) > maxThreads) {
+      cerr << "Note: -Threads " << nThreads << " exceeds the "
+           << maxThreads << " hardware thread(s); " << maxThreads
+           << " used" << endl;
+      nThreads = maxThreads;
+   }
+   return true;
+}
+
 //----------------------------------------------------------------------
-//    CIRRead <(string fileName)> [-Replace]
+//    CIRRead <(string fileName)> [-Replace] [-Threads (int num)]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirReadCmd::exec(const string& option)
@@ -57,12 +112,20 @@ CirReadCmd::exec(const string& option)
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
    bool doReplace = false;
+   int nThreads = 0;
    string fileName;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Replace", options[i], 2) == 0) {
          if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
          doReplace = true;
       }
+      else if (myStrNCmp("-Threads", options[i], 2) == 0) {
+         if (nThreads) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!str2Threads(options[i], nThreads))
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
       else {
          if (fileName.size())
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
@@ -83,7 +146,7 @@ CirReadCmd::exec(const string& option)
    }
    cirMgr = new CirMgr;
 
-   if (!cirMgr->readCircuit(fileName)) {
+   if (!cirMgr->readCircuit(fileName, nThreads? nThreads: 1)) {
       curCmd = CIRINIT;
       delete cirMgr; cirMgr = 0;
       return CMD_EXEC_ERROR;
@@ -97,18 +160,20 @@ CirReadCmd::exec(const string& option)
 void
 CirReadCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRRead <(string fileName)> [-Replace]" << endl;
+   os << "Usage: CIRRead <(string fileName)> [-Replace] [-Threads (int num)]"
+      << endl;
 }
 
 void
 CirReadCmd::help() const
 {
    cout << setw(15) << left << "CIRRead: "
-        << "read in a circuit and construct the netlist" << endl;
+        << "read in a circuit (.aag or .aig) and construct the netlist"
+        << endl;
 }
 
 //----------------------------------------------------------------------
-//    CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating ]
+//    CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating | -FECpairs]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirPrintCmd::exec(const string& option)
@@ -132,10 +197,13 @@ CirPrintCmd::exec(const string& option)
       cirMgr->printPOs();
    else if (myStrNCmp("-FLoating", token, 3) == 0)
       cirMgr->printFloatGates();
-/*
    else if (myStrNCmp("-FECpairs", token, 4) == 0)
       cirMgr->printFECPairs();
-*/
+   else if (myStrNCmp("-Memory", token, 2) == 0) {
+      cirMgr->printMemory();
+      cout << endl;
+      MyMemStat::report();
+   }
    else
       return CmdExec::errorOption(CMD_OPT_ILLEGAL, token);
 
@@ -145,10 +213,8 @@ CirPrintCmd::exec(const string& option)
 void
 CirPrintCmd::usage(ostream& os) const
 {  
-   os << "Usage: CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating]"
-      << endl;
-//   os << "Usage: CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating "
-//      << "| -FECpairs]" << endl;
+   os << "Usage: CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating "
+      << "| -FECpairs | -Memory]" << endl;
 }
 
 void
@@ -178,7 +244,7 @@ CirGateCmd::exec(const string& option)
 
    int gateId = -1, level = 0;
    bool doFanin = false, doFanout = false;
-   CirGate* thisGate = 0;
+   CirGate thisGate;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       bool checkLevel = false;
       if (myStrNCmp("-FANIn", options[i], 5) == 0) {
@@ -221,11 +287,11 @@ CirGateCmd::exec(const string& option)
    }
 
    if (doFanin)
-      thisGate->reportFanin(level,gateId);
+      thisGate.reportFanin(level,gateId);
    else if (doFanout)
-      thisGate->reportFanout(level,gateId);
+      thisGate.reportFanout(level,gateId);
    else
-      thisGate->reportGate(gateId);
+      thisGate.reportGate(gateId);
    // add gateId
 
    return CMD_EXEC_DONE;
@@ -246,7 +312,7 @@ CirGateCmd::help() const
 
 
 //----------------------------------------------------------------------
-//    CIRWrite [-Output (string aagFile)]
+//    CIRWrite [-Binary] [-Output (string aagFile)]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirWriteCmd::exec(const string& option)
@@ -259,19 +325,36 @@ CirWriteCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (options.empty())
-      cirMgr->writeAag(cout);
-   else if (myStrNCmp("-Output", options[0], 2) == 0) {
-      if (options.size() == 1)
-         return CmdExec::errorOption(CMD_OPT_MISSING, options[0]);
-      if (options.size() > 2)
-         return CmdExec::errorOption(CMD_OPT_EXTRA, options[2]);
-      ofstream outfile(options[1].c_str(), ios::out);
+   bool doBinary = false;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Binary", options[i], 2) == 0) {
+         if (doBinary) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doBinary = true;
+      }
+      else if (myStrNCmp("-Output", options[i], 2) == 0) {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         fileName = options[i];
+      }
+      else if (fileName.size())
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   if (fileName.empty()) {
+      if (doBinary) cirMgr->writeBinaryAig(cout);
+      else cirMgr->writeAag(cout);
+   }
+   else {
+      ofstream outfile(fileName.c_str(), ios::out | ios::binary);
       if (!outfile)
-         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[1]);
-      cirMgr->writeAag(outfile);
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+      if (doBinary) cirMgr->writeBinaryAig(outfile);
+      else cirMgr->writeAag(outfile);
    }
-   else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[0]);
 
    return CMD_EXEC_DONE;
 }
@@ -279,13 +362,406 @@ CirWriteCmd::exec(const string& option)
 void
 CirWriteCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRWrite [-Output (string aagFile)]" << endl;
+   os << "Usage: CIRWrite [-Binary] [-Output (string aagFile)]" << endl;
 }
 
 void
 CirWriteCmd::help() const
 {
    cout << setw(15) << left << "CIRWrite: "
-        << "write the netlist to an ASCII AIG file (.aag)\n";
+        << "write the netlist to an AIG file (.aag, or .aig with -Binary)\n";
+}
+
+
+//----------------------------------------------------------------------
+//    CIRSim <-Random | -Bench | -Flip <(int gateId)>...>
+//           [-Threads (int num) [-Words]]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSimCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   bool doRandom = false, doBench = false, doFlip = false, doWords = false;
+   int nThreads = 0;
+   IdList pis;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Random", options[i], 2) == 0) {
+         if (doRandom || doBench || doFlip)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doRandom = true;
+      }
+      else if (myStrNCmp("-Bench", options[i], 2) == 0) {
+         if (doRandom || doBench || doFlip)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doBench = true;
+      }
+      else if (myStrNCmp("-Flip", options[i], 2) == 0) {
+         if (doRandom || doBench || doFlip)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doFlip = true;
+         int gateId;
+         while (i + 1 < n && myStr2Int(options[i+1], gateId)) {
+            ++i;
+            CirGate g = gateId < 0 ? CirGate() : cirMgr->getGate(gateId);
+            if (!g || g.getType() != PI_GATE) {
+               cerr << "Error: Gate(" << options[i] << ") is not a PI!!"
+                    << endl;
+               return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+            }
+            pis.push_back(gateId);
+         }
+         if (pis.empty())
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i]);
+      }
+      else if (myStrNCmp("-Threads", options[i], 2) == 0) {
+         if (nThreads) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!str2Threads(options[i], nThreads))
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Words", options[i], 2) == 0) {
+         if (doWords) return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doWords = true;
+      }
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+   if (!doRandom && !doBench && !doFlip)
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if (doWords && !doRandom)
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, "-Words");
+
+   if (doFlip && nThreads != 0)
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, "-Threads");
+   if (nThreads == 0) nThreads = 1;
+
+   if (doRandom)
+      cirMgr->randomSim(nThreads, doWords);
+   else if (doBench)
+      cirMgr->benchSim(nThreads);
+   else
+      cirMgr->flipSim(pis);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSimCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSim <-Random | -Bench | -Flip <(int gateId)>...>" << endl
+      << "              [-Threads (int num) [-Words]]" << endl;
+}
+
+void
+CirSimCmd::help() const
+{
+   cout << setw(15) << left << "CIRSim: "
+        << "perform bit-parallel random simulation\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSWeep
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSweepCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->sweep();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSweepCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSWeep" << endl;
+}
+
+void
+CirSweepCmd::help() const
+{
+   cout << setw(15) << left << "CIRSWeep: "
+        << "remove unused gates\n";
+}
+
+//----------------------------------------------------------------------
+//    CIROPTimize
+//----------------------------------------------------------------------
+CmdExecStatus
+CirOptCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->optimize();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirOptCmd::usage(ostream& os) const
+{
+   os << "Usage: CIROPTimize" << endl;
 }
 
+void
+CirOptCmd::help() const
+{
+   cout << setw(15) << left << "CIROPTimize: "
+        << "perform trivial optimizations\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRSTRash
+//----------------------------------------------------------------------
+CmdExecStatus
+CirStrashCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token))
+      return CMD_EXEC_ERROR;
+   if (!token.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, token);
+
+   cirMgr->strash();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirStrashCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSTRash" << endl;
+}
+
+void
+CirStrashCmd::help() const
+{
+   cout << setw(15) << left << "CIRSTRash: "
+        << "perform structural hash on the circuit netlist\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRFraig [-Threads (int num)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirFraigCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   int nThreads = 0;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Threads", options[i], 2) == 0) {
+         if (nThreads) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!str2Threads(options[i], nThreads))
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+   cirMgr->fraig(nThreads);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirFraigCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRFraig [-Threads (int num)]" << endl;
+}
+
+void
+CirFraigCmd::help() const
+{
+   cout << setw(15) << left << "CIRFraig: "
+        << "perform Boolean logic simplification on the circuit\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRGENerate <(string aagFile)> [-PI (int num)] [-PO (int num)]
+//                [-AND (int num)] [-Depth (int num)] [-Hub (int pct)]
+//                [-Undef (int pct)] [-Float (int pct)] [-Seed (int seed)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirGenCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   // option name, its minimum length, value, upper bound and whether given
+   struct GenOpt {
+      const char*  _name;
+      unsigned     _len;
+      int          _value;
+      int          _max;
+      bool         _set;
+   } opts[] = {
+      { "-PI",    3, 64,    INT_MAX, false },
+      { "-PO",    3, 64,    INT_MAX, false },
+      { "-AND",   2, 10000, INT_MAX, false },
+      { "-Depth", 2, 32,    INT_MAX, false },
+      { "-Hub",   2, 10,    100,     false },
+      { "-Undef", 2, 0,     100,     false },
+      { "-Float", 2, 0,     100,     false },
+      { "-Seed",  2, 0,     INT_MAX, false }
+   };
+   const size_t nOpts = sizeof(opts) / sizeof(opts[0]);
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      size_t k = 0;
+      while (k < nOpts && myStrNCmp(opts[k]._name, options[i], opts[k]._len))
+         ++k;
+      if (k == nOpts) {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (options[i][0] == '-')
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         fileName = options[i];
+         continue;
+      }
+      if (opts[k]._set) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+      opts[k]._set = true;
+      if (++i == n)
+         return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+      if (!myStr2Int(options[i], opts[k]._value) || opts[k]._value < 0 ||
+          opts[k]._value > opts[k]._max)
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+   if (fileName.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if (opts[0]._value == 0)
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, "-PI");
+   if (opts[3]._value == 0)
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, "-Depth");
+
+   CirMgr::GenParam p;
+   p.inputs = opts[0]._value;
+   p.outputs = opts[1]._value;
+   p.ands = opts[2]._value;
+   p.depth = opts[3]._value;
+   p.hubPct = opts[4]._value;
+   p.undefPct = opts[5]._value;
+   p.floatPct = opts[6]._value;
+   p.seed = opts[7]._value;
+   ofstream outfile(fileName.c_str(), ios::out | ios::binary);
+   if (!outfile)
+      return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, fileName);
+   CirMgr::genAag(outfile, p);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirGenCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRGENerate <(string aagFile)> [-PI (int num)] "
+      << "[-PO (int num)]" << endl
+      << "                   [-AND (int num)] [-Depth (int num)] "
+      << "[-Hub (int pct)]" << endl
+      << "                   [-Undef (int pct)] [-Float (int pct)] "
+      << "[-Seed (int seed)]" << endl;
+}
+
+void
+CirGenCmd::help() const
+{
+   cout << setw(15) << left << "CIRGENerate: "
+        << "write a random circuit of the given shape\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRPROFile [-Calls | -Reset | -Json (string jsonFile)]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirProfileCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+
+   bool doCalls = false, doReset = false;
+   string jsonFile;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (doCalls || doReset || jsonFile.size())
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+      if (myStrNCmp("-Calls", options[i], 2) == 0) doCalls = true;
+      else if (myStrNCmp("-Reset", options[i], 2) == 0) doReset = true;
+      else if (myStrNCmp("-Json", options[i], 2) == 0) {
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         jsonFile = options[i];
+      }
+      else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+
+   if (doReset) myProfile.reset();
+   else if (jsonFile.size()) {
+      // fail now rather than at exit
+      ofstream ofs(jsonFile.c_str());
+      if (!ofs) return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, jsonFile);
+      myProfile.setExitJson(jsonFile);
+   }
+   else myProfile.report(doCalls);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirProfileCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRPROFile [-Calls | -Reset | -Json (string jsonFile)]"
+      << endl;
+}
+
+void
+CirProfileCmd::help() const
+{
+   cout << setw(15) << left << "CIRPROFile: "
+        << "report the time and memory of every cir command\n";
+}
@@ -15,5 +15,12 @@ CmdClass(CirReadCmd);
 CmdClass(CirPrintCmd);
 CmdClass(CirGateCmd);
 CmdClass(CirWriteCmd);
+CmdClass(CirSimCmd);
+CmdClass(CirSweepCmd);
+CmdClass(CirOptCmd);
+CmdClass(CirStrashCmd);
+CmdClass(CirFraigCmd);
+CmdClass(CirGenCmd);
+CmdClass(CirProfileCmd);
 
 #endif // CIR_CMD_H
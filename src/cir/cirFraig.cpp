@@ -0,0 +1,446 @@
+/****************************************************************************
+  FileName     [ cirFraig.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir FRAIG functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2012-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "cirGate.h"
+#include "cirMgr.h"
+#include "myThreadPool.h"
+#include "sat.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// conflicts allowed per SAT call; a pair left undecided is not merged
+enum {
+    FRAIG_CONFLICT_LIMIT = 10000,
+    // solvers of fraigParallel(), and so the most threads it can use
+    FRAIG_SOLVERS = 8
+};
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static const unsigned NO_VAR = ~0u;
+
+// One SAT solver holding the Tseitin encoding of every gate cone it was
+// asked about. A cone is encoded on the netlist as it is when first
+// needed. Later merges must add their equivalences to the solver (prove()
+// does, addMerge() for the merges of other solvers), so that a gate
+// encoded on a merged fanin still agrees with the rewritten netlist.
+// Solvers on other threads only read the netlist.
+class FraigSolver {
+   public:
+    FraigSolver(const CirMgr::ParsedCir &cir)
+        : _cir(cir), _satVar(cir.size(), NO_VAR), _assumps(2) {
+        // CONST and UNDEF gates share this constant-false var, as
+        // simulation keeps them at 0
+        _satVar[0] = _solver.newVar();
+        _solver.addClause(_satVar[0] * 2 + 1);
+    }
+    // Is the gate of literal m equal to literal rep? Either direction of
+    // a difference is a separate call. UNSAT adds the equivalence to the
+    // solver; SAT leaves a counterexample for getCex().
+    SatResult prove(unsigned rep, unsigned m) {
+        const unsigned a = satLit(rep), b = satLit(m & ~1u);
+        coneVars(rep, m);
+        _solver.setDecisionVars(_cone);
+        _assumps[0] = a;
+        _assumps[1] = b ^ 1;
+        SatResult r = _solver.solve(_assumps, FRAIG_CONFLICT_LIMIT);
+        if (r != SAT_UNSAT) return r;
+        _assumps[0] = a ^ 1;
+        _assumps[1] = b;
+        r = _solver.solve(_assumps, FRAIG_CONFLICT_LIMIT);
+        if (r != SAT_UNSAT) return r;
+        _solver.addClause(a ^ 1, b);
+        _solver.addClause(a, b ^ 1);
+        return r;
+    }
+    // add the equivalence of a merge proven by another solver, if gate m
+    // is encoded here
+    void addMerge(unsigned rep, unsigned m) {
+        if (_satVar[m / 2] == NO_VAR) return;
+        const unsigned a = satLit(rep), b = satLit(m & ~1u);
+        _solver.addClause(a ^ 1, b);
+        _solver.addClause(a, b ^ 1);
+    }
+    // append the PI values of the last counterexample as one bit per PI
+    // position; PIs outside the compared cones are 0
+    void getCex(vector<uint64_t> &cexs) const {
+        size_t base = cexs.size();
+        cexs.resize(base + (_cir.inputs + 63) / 64, 0);
+        for (size_t k = 0; k < _cir.inputs; k++) {
+            unsigned v = _satVar[_cir.PI_list[k]];
+            if (v != NO_VAR && _solver.getValue(v))
+                cexs[base + k / 64] |= uint64_t(1) << (k % 64);
+        }
+    }
+
+   private:
+    const CirMgr::ParsedCir &_cir;
+    SatSolver _solver;
+    IdList _satVar;
+    // traversal marks of coneVars()
+    CirTravCtx _coneTrav;
+    IdList _cone, _stack, _assumps;
+
+    // SAT literal of the AIG literal lit, encoding the gates of its cone
+    // that have no var yet
+    unsigned satLit(unsigned lit) {
+        _stack.assign(1, lit / 2);
+        while (!_stack.empty()) {
+            unsigned id = _stack.back();
+            if (_satVar[id] != NO_VAR) {
+                _stack.pop_back();
+                continue;
+            }
+            if (_cir.type[id] != AIG_GATE) {
+                _satVar[id] =
+                    (_cir.type[id] == PI_GATE) ? _solver.newVar() : _satVar[0];
+                _stack.pop_back();
+                continue;
+            }
+            const unsigned *c = _cir.fanin + id * 2;
+            if (_satVar[c[0] / 2] == NO_VAR || _satVar[c[1] / 2] == NO_VAR) {
+                _stack.push_back(c[0] / 2);
+                _stack.push_back(c[1] / 2);
+                continue;
+            }
+            _satVar[id] = _solver.newVar();
+            _solver.addAnd(_satVar[id] * 2,
+                           _satVar[c[0] / 2] * 2 + (c[0] & 1),
+                           _satVar[c[1] / 2] * 2 + (c[1] & 1));
+            _stack.pop_back();
+        }
+        return _satVar[lit / 2] * 2 + (lit & 1);
+    }
+    // Vars of the gates in the fanin cones of literals a and b into
+    // _cone. The rest of the solver's gates need no decisions: a model of
+    // the cones extends to them by evaluation.
+    void coneVars(unsigned a, unsigned b) {
+        _cone.clear();
+        _stack.assign(1, a / 2);
+        _stack.push_back(b / 2);
+        _coneTrav.begin(_cir.size());
+        while (!_stack.empty()) {
+            unsigned id = _stack.back();
+            _stack.pop_back();
+            if (_coneTrav.isMarked(id) || _satVar[id] == _satVar[0]) continue;
+            _coneTrav.mark(id);
+            _cone.push_back(_satVar[id]);
+            if (_cir.type[id] != AIG_GATE) continue;
+            _stack.push_back(_cir.fanin[id * 2] / 2);
+            _stack.push_back(_cir.fanin[id * 2 + 1] / 2);
+        }
+    }
+};
+
+// Flat open-addressing table from a normalized fanin pair to an AND id.
+// A slot holds both 32-bit literals of the key next to the id, 12 bytes
+// in all, so a probe touches one cache line; a first literal of all ones
+// marks an empty slot. The load factor stays at 2/3 or below.
+class StrashTable {
+   public:
+    StrashTable(size_t n) : _mask(1) {
+        while (_mask < n + n / 2) _mask <<= 1;
+        _slot.assign(_mask, Slot());
+        _mask--;
+    }
+    // id of the AND keyed (a, b), or inserts id and returns it
+    unsigned insert(unsigned a, unsigned b, unsigned id) {
+        uint64_t key = (uint64_t(a) << 32) | b;
+        size_t k = size_t((key * 0x9e3779b97f4a7c15ULL) >> 32) & _mask;
+        while (_slot[k].a != EMPTY) {
+            if (_slot[k].a == a && _slot[k].b == b) return _slot[k].id;
+            k = (k + 1) & _mask;
+        }
+        _slot[k].a = a;
+        _slot[k].b = b;
+        _slot[k].id = id;
+        return id;
+    }
+
+   private:
+    static const unsigned EMPTY = ~0u;
+    struct Slot {
+        Slot() : a(EMPTY), b(0), id(0) {}
+        unsigned a, b, id;
+    };
+    size_t _mask;
+    vector<Slot> _slot;
+};
+
+/*******************************************/
+/*   Public member functions about fraig   */
+/*******************************************/
+// Walk the ANDs in DFS order and merge each one whose (smaller, larger)
+// fanin literal pair was seen before into the first gate with that pair.
+// Fanins are rewritten in place when a gate is merged, so every gate is
+// hashed after all of its fanins are final. The fanout index is rebuilt
+// once at the end.
+void CirMgr::strash() {
+    TRACE_SPAN("strash");
+    MEM_PHASE("optimize");
+    const vector<unsigned> &dfs = getDfsList();
+    StrashTable table(dfs.size());
+    size_t merged = 0;
+    for (size_t i = 0; i < dfs.size(); i++) {
+        unsigned id = dfs[i];
+        if (Circuit.type[id] != AIG_GATE) continue;
+        const unsigned *c = Circuit.fanin + id * 2;
+        unsigned rep = (c[0] < c[1]) ? table.insert(c[0], c[1], id)
+                                     : table.insert(c[1], c[0], id);
+        if (rep == id) continue;
+        cout << "Strashing: " << rep << " merging " << id << "..." << endl;
+        mergeGate(rep * 2, id);
+        merged++;
+    }
+    if (merged != 0) ConstructCir(1);
+}
+
+// Prove or refute the FEC candidates of the last simulation with SAT. In
+// every round each member of a group is compared with the group's leader,
+// its earliest gate in DFS order, members taken in DFS order. A proven
+// member is merged into the leader at once. A counterexample becomes one
+// pattern of the next simulation block; once the block is full, or the
+// round is over, it is simulated on the current netlist and splits the
+// groups. A group's leader stays first in every part it splits into, so
+// a leader is never merged and its fanouts are never rewritten.
+//
+// With nThreads != 0 see fraigParallel().
+void CirMgr::fraig(unsigned nThreads) {
+    TRACE_SPAN("fraig");
+    MEM_PHASE("fraig");
+    if (!_fecValid) {
+        cerr << "Error: circuit has not been simulated!!" << endl;
+        return;
+    }
+    if (nThreads != 0) {
+        fraigParallel(nThreads);
+        return;
+    }
+    vector<IdList> groups(_fecGroups);
+    // DFS order of the netlist before any merge; it stays topological, as
+    // a leader precedes the member whose fanouts are moved to it
+    const IdList dfs(getDfsList());
+    IdList order(Circuit.size(), 0);
+    for (size_t i = 0; i < dfs.size(); i++) order[dfs[i]] = i;
+
+    // one solver for the whole run
+    FraigSolver solver(Circuit);
+    // a member is done once merged or undecided
+    vector<bool> done(Circuit.size(), false);
+    vector<uint64_t> cexs;
+    size_t merged = 0;
+    while (!groups.empty()) {
+        // (member, leader) literal pairs
+        vector<pair<unsigned, unsigned> > cands;
+        for (size_t g = 0; g < groups.size(); g++)
+            for (size_t i = 1; i < groups[g].size(); i++)
+                cands.push_back(make_pair(groups[g][i], groups[g][0]));
+        sort(cands.begin(), cands.end(),
+             [&](const pair<unsigned, unsigned> &x,
+                 const pair<unsigned, unsigned> &y) {
+                 return order[x.first / 2] < order[y.first / 2];
+             });
+        cexs.clear();
+        size_t nCex = 0;
+        for (size_t i = 0; i < cands.size() && nCex < 64 * SIM_WORDS; i++) {
+            const unsigned m = cands[i].first, l = cands[i].second;
+            // m's gate equals rep, the leader's gate possibly inverted
+            const unsigned inv = (m ^ l) & 1, rep = (l & ~1u) | inv;
+            SatResult r = solver.prove(rep, m);
+            if (r == SAT_SAT) {
+                solver.getCex(cexs);
+                nCex++;
+                continue;
+            }
+            done[m / 2] = true;
+            if (r == SAT_UNDEF) continue;
+            cout << "Fraig: " << l / 2 << " merging " << (inv ? "!" : "")
+                 << m / 2 << "..." << endl;
+            mergeGate(rep, m / 2);
+            merged++;
+        }
+        if (nCex == 0) break;
+        refineByCex(groups, done, dfs, cexs);
+    }
+    if (merged != 0) ConstructCir(1);
+}
+
+/********************************************/
+/*   Private member functions about fraig   */
+/********************************************/
+// FRAIG_SOLVERS solvers share the work, each kept for the whole run.
+// Every round takes the candidates whose member has the lowest logic
+// level left, so that, as in fraig(), the merges below a pair are known
+// before it is proven. They are sorted by the member's DFS order and cut
+// into FRAIG_SOLVERS runs of equal length; solver s takes run s and stops
+// after its share of one block of counterexamples. The threads pick up
+// the solvers one at a time and only read the netlist. After the round
+// the merges are done and printed in solver order, which is the members'
+// DFS order, and the counterexamples refine the groups. Before its next
+// run, a solver adds the merges the other solvers proved. A solver only
+// sees what the rounds give it, so the result is the same for every
+// nThreads.
+void CirMgr::fraigParallel(unsigned nThreads) {
+    TRACE_SPAN("fraigParallel");
+    vector<IdList> groups(_fecGroups);
+    const IdList dfs(getDfsList());
+    IdList order(Circuit.size(), 0);
+    for (size_t i = 0; i < dfs.size(); i++) order[dfs[i]] = i;
+    IdList level;
+    levelize(level);
+
+    MyThreadPool pool(min<unsigned>(nThreads, FRAIG_SOLVERS));
+    vector<FraigSolver *> solvers(FRAIG_SOLVERS);
+    for (unsigned s = 0; s < FRAIG_SOLVERS; s++)
+        solvers[s] = new FraigSolver(Circuit);
+    const size_t cexLimit = 64 * SIM_WORDS / FRAIG_SOLVERS;
+    vector<bool> done(Circuit.size(), false);
+    // per solver: (member, replacement) literals to merge, undecided
+    // members, counterexamples, and how much of all it has added
+    vector<vector<pair<unsigned, unsigned> > > merges(FRAIG_SOLVERS);
+    vector<IdList> undecided(FRAIG_SOLVERS);
+    vector<vector<uint64_t> > cexs(FRAIG_SOLVERS);
+    vector<size_t> added(FRAIG_SOLVERS, 0);
+    // all merges so far and the solver that proved each
+    vector<pair<unsigned, unsigned> > all;
+    IdList provedBy;
+    vector<uint64_t> allCexs;
+    while (!groups.empty()) {
+        // (member, leader) literal pairs
+        unsigned wave = ~0u;
+        for (size_t g = 0; g < groups.size(); g++)
+            for (size_t i = 1; i < groups[g].size(); i++)
+                wave = min(wave, level[groups[g][i] / 2]);
+        if (wave == ~0u) break;
+        vector<pair<unsigned, unsigned> > cands;
+        for (size_t g = 0; g < groups.size(); g++)
+            for (size_t i = 1; i < groups[g].size(); i++)
+                if (level[groups[g][i] / 2] == wave)
+                    cands.push_back(make_pair(groups[g][i], groups[g][0]));
+        sort(cands.begin(), cands.end(),
+             [&](const pair<unsigned, unsigned> &x,
+                 const pair<unsigned, unsigned> &y) {
+                 return order[x.first / 2] < order[y.first / 2];
+             });
+        atomic<unsigned> next(0);
+        pool.run([&](unsigned) {
+            for (unsigned s; (s = next++) < FRAIG_SOLVERS;) {
+                TRACE_SPAN("fraigSolver");
+                FraigSolver &solver = *solvers[s];
+                for (; added[s] < all.size(); added[s]++)
+                    if (provedBy[added[s]] != s)
+                        solver.addMerge(all[added[s]].second,
+                                        all[added[s]].first);
+                merges[s].clear();
+                undecided[s].clear();
+                cexs[s].clear();
+                size_t nCex = 0;
+                const size_t end = cands.size() * (s + 1) / FRAIG_SOLVERS;
+                for (size_t i = cands.size() * s / FRAIG_SOLVERS;
+                     i < end && nCex < cexLimit; i++) {
+                    const unsigned m = cands[i].first, l = cands[i].second;
+                    const unsigned rep = (l & ~1u) | ((m ^ l) & 1);
+                    SatResult r = solver.prove(rep, m);
+                    if (r == SAT_SAT) {
+                        solver.getCex(cexs[s]);
+                        nCex++;
+                    } else if (r == SAT_UNSAT)
+                        merges[s].push_back(make_pair(m, rep));
+                    else
+                        undecided[s].push_back(m / 2);
+                }
+            }
+        });
+        allCexs.clear();
+        for (unsigned s = 0; s < FRAIG_SOLVERS; s++) {
+            for (size_t i = 0; i < merges[s].size(); i++) {
+                const unsigned m = merges[s][i].first;
+                const unsigned rep = merges[s][i].second;
+                cout << "Fraig: " << rep / 2 << " merging "
+                     << ((rep & 1) ? "!" : "") << m / 2 << "..." << endl;
+                mergeGate(rep, m / 2);
+                done[m / 2] = true;
+                all.push_back(merges[s][i]);
+                provedBy.push_back(s);
+            }
+            for (size_t i = 0; i < undecided[s].size(); i++)
+                done[undecided[s][i]] = true;
+            allCexs.insert(allCexs.end(), cexs[s].begin(), cexs[s].end());
+        }
+        refineByCex(groups, done, dfs, allCexs);
+    }
+    for (unsigned s = 0; s < FRAIG_SOLVERS; s++) delete solvers[s];
+    if (!all.empty()) ConstructCir(1);
+}
+
+// Drop the done members from groups, then split the groups by cexs, the
+// counterexamples of getCex(), one simulation block at a time. The
+// netlist is simulated in the order of dfs, the DFS list before the
+// merges, so the ANDs a merge left floating still get values.
+void CirMgr::refineByCex(vector<IdList> &groups, const vector<bool> &done,
+                         const IdList &dfs, const vector<uint64_t> &cexs) {
+    TRACE_SPAN("refineByCex");
+    for (size_t g = 0; g < groups.size(); g++) {
+        IdList &group = groups[g];
+        size_t k = 1;
+        for (size_t i = 1; i < group.size(); i++)
+            if (!done[group[i] / 2]) group[k++] = group[i];
+        group.resize(k);
+    }
+    if (cexs.empty()) return;
+    IdList prog, levelEnd;
+    for (size_t i = 0; i < dfs.size(); i++) {
+        if (Circuit.type[dfs[i]] != AIG_GATE) continue;
+        prog.push_back(dfs[i]);
+        prog.push_back(Circuit.fanin[dfs[i] * 2]);
+        prog.push_back(Circuit.fanin[dfs[i] * 2 + 1]);
+    }
+    MyThreadPool pool(1);
+    const size_t words = (Circuit.inputs + 63) / 64;
+    const size_t nCex = words ? cexs.size() / words : 0;
+    vector<uint64_t> sim(Circuit.size() * SIM_WORDS);
+    for (size_t b = 0; b < nCex; b += 64 * SIM_WORDS) {
+        // patterns past the last counterexample are all 0
+        fill(sim.begin(), sim.end(), 0);
+        for (size_t j = b; j < nCex && j < b + 64 * SIM_WORDS; j++) {
+            const uint64_t *cex = &cexs[j * words];
+            for (size_t k = 0; k < Circuit.inputs; k++)
+                if ((cex[k / 64] >> (k % 64)) & 1)
+                    sim[Circuit.PI_list[k] * SIM_WORDS + (j - b) / 64] |=
+                        uint64_t(1) << ((j - b) % 64);
+        }
+        simulateBlock(&sim[0], prog, levelEnd, pool);
+        refineFecGroups(groups, &sim[0]);
+    }
+}
+
+// Replace gate id by literal lit in the fanins of all of id's fanouts
+// and remove id. The fanout index of id must still be valid; it is left
+// stale for the caller to rebuild.
+void CirMgr::mergeGate(unsigned lit, unsigned id) {
+    assert(lit / 2 != id);
+    const unsigned *f = Circuit.fanoutLit + Circuit.fanoutOfs[id];
+    for (unsigned k = 0, n = Circuit.getFanoutNum(id); k < n; k++) {
+        unsigned *c = Circuit.fanin + (f[k] / 2) * 2;
+        for (unsigned j = 0; j < 2; j++)
+            if (c[j] / 2 == id) c[j] = lit ^ (c[j] & 1);
+    }
+    if (Circuit.type[id] == AIG_GATE) Circuit.ands--;
+    Circuit.type[id] = TOT_GATE;
+    invalidateDfsList();
+}
@@ -13,6 +13,7 @@
 #include <cassert>
 #include "cirGate.h"
 #include "cirMgr.h"
+#include "myOutBuf.h"
 #include "util.h"
 
 using namespace std;
@@ -21,93 +22,120 @@ extern CirMgr *cirMgr;
 
 // TODO: Implement memeber functions for class(es) in cirGate.h
 
+/****************************************/
+/*   class CirTravCtx member functions  */
+/****************************************/
+CirTravCtx& CirTravCtx::forThread() {
+   static thread_local CirTravCtx ctx;
+   return ctx;
+}
+
 /**************************************/
 /*   class CirGate member functions   */
 /**************************************/
-unsigned CirGate::_globalref = 0;
-void CirGate::FaninDFS(int lit,unsigned maxlev,unsigned curlev = 0) const{
-   if(curlev > maxlev) return;
-   unsigned* c = this->getFanin();
-   for(unsigned i = 0;i<curlev;i++){
-      cout << "  ";
-   }
-   cout << ((lit %2 == 0)? "" : "!")<< this->getTypeStr() << " " << lit/2;
-   if(this->isGlobalref() && curlev != maxlev && !(this->getType() == PI_GATE || this->getType() == CONST_GATE || this->getType() == UNDEF_GATE)){
-      cout << " (*)" << endl;
-      return;
-   }
-   else{
-      cout << endl;
-   }
-   if(curlev != maxlev) this->setRefToGlobalRef();
-   if(this->getType() == PO_GATE){
-      cirMgr->Circuit.id2Gate[*c/2]->FaninDFS(*c,maxlev,curlev+1);
-   }
-   else if(this->getType() == AIG_GATE){
-      cirMgr->Circuit.id2Gate[c[0]/2]->FaninDFS(c[0],maxlev,curlev+1);
-      cirMgr->Circuit.id2Gate[c[1]/2]->FaninDFS(c[1],maxlev,curlev+1);
-   }
-   else{
-      return;
+static const char* gateTypeStr[TOT_GATE] = {"UNDEF", "PI", "PO", "AIG",
+                                            "CONST"};
+string CirGate::getTypeStr() const { return gateTypeStr[getType()]; }
+// Both reports print a pre-order walk limited to maxlev levels. They use
+// an explicit stack of (literal, level) with the children pushed in
+// reverse, so a gate's "(*)" is still decided when it is printed and deep
+// netlists cannot overflow the call stack.
+void CirGate::FaninDFS(MyOutBuf& out,CirTravCtx& trav,int lit,unsigned maxlev,unsigned curlev = 0) const{
+   vector<pair<unsigned,unsigned> > stack(1, make_pair(unsigned(lit), curlev));
+   while(!stack.empty()){
+      lit = stack.back().first;
+      curlev = stack.back().second;
+      stack.pop_back();
+      if(curlev > maxlev) continue;
+      CirGate g(_cir, lit/2);
+      const unsigned* c = g.getFanin();
+      for(unsigned i = 0;i<curlev;i++){
+         out << "  ";
+      }
+      out << ((lit %2 == 0)? "" : "!")<< g.getTypeStr() << ' ' << lit/2;
+      if(trav.isMarked(lit/2) && curlev != maxlev && !(g.getType() == PI_GATE || g.getType() == CONST_GATE || g.getType() == UNDEF_GATE)){
+         out << " (*)\n";
+         continue;
+      }
+      else{
+         out << '\n';
+      }
+      if(curlev != maxlev) trav.mark(lit/2);
+      if(g.getType() == PO_GATE){
+         stack.push_back(make_pair(c[0], curlev+1));
+      }
+      else if(g.getType() == AIG_GATE){
+         stack.push_back(make_pair(c[1], curlev+1));
+         stack.push_back(make_pair(c[0], curlev+1));
+      }
    }
 }
-void CirGate::FanoutDFS(int lit,unsigned maxlev,unsigned curlev = 0) const{
-   if(curlev > maxlev) return;
-   
-   const vector<unsigned>& v = const_cast<CirGate*>(this)->getFanout();
-   for(unsigned i = 0;i<curlev;i++){
-      cout << "  ";
-   }
-   
-   cout << ((lit %2 == 0)? "" : "!")<< this->getTypeStr() << " " << lit/2;
-   if(this->isGlobalref()&& !v.empty() && curlev != maxlev){
-         cout << " (*)" << endl;
-         return;
-   }
-   else{
-      cout << endl;
-   }
-   if(curlev != maxlev)this->setRefToGlobalRef();
-   if(v.empty()){
-      return;
-   }
-   else{
-      for(size_t i = 0;i<v.size();i++){
-         cirMgr->Circuit.id2Gate[v[i]/2]->FanoutDFS(v[i],maxlev,curlev+1);
+void CirGate::FanoutDFS(MyOutBuf& out,CirTravCtx& trav,int lit,unsigned maxlev,unsigned curlev = 0) const{
+   vector<pair<unsigned,unsigned> > stack(1, make_pair(unsigned(lit), curlev));
+   while(!stack.empty()){
+      lit = stack.back().first;
+      curlev = stack.back().second;
+      stack.pop_back();
+      if(curlev > maxlev) continue;
+      CirGate g(_cir, lit/2);
+      const unsigned* v = g.getFanout();
+      const unsigned n = g.getFanoutNum();
+      for(unsigned i = 0;i<curlev;i++){
+         out << "  ";
+      }
+      out << ((lit %2 == 0)? "" : "!")<< g.getTypeStr() << ' ' << lit/2;
+      if(trav.isMarked(lit/2)&& n != 0 && curlev != maxlev){
+         out << " (*)\n";
+         continue;
+      }
+      else{
+         out << '\n';
+      }
+      if(curlev != maxlev) trav.mark(lit/2);
+      for(size_t i = n;i>0;i--){
+         stack.push_back(make_pair(v[i-1], curlev+1));
       }
    }
 }
 void
 CirGate::reportGate(int id) const
 {
-   cout << "==================================================" << endl;
-   stringstream ss;
-   ss << "= " << getTypeStr() << "(" << id << ")";
+   MyOutBuf out(cout);
+   out << "==================================================\n";
+   size_t start = out.count();
+   out << "= " << getTypeStr() << '(' << id << ')';
    if(getType() == PI_GATE || getType() == PO_GATE){
-      SymbolGate* s = dynamic_cast<SymbolGate*>(const_cast<CirGate*>(this));
-      if(s->getSymbol() != 0){
-         ss << "\"" << s->getSymbol() << "\"";
-      }      
+      if(getSymbol() != 0){
+         out << '"' << getSymbol() << '"';
+      }
    }
-   ss <<", line "  << getLineNo();
-   cout  << ss.str() << setw(50 - ss.str().size()) << "=" << endl;
-   cout << "==================================================" << endl;
+   out <<", line "  << getLineNo();
+   // "=" closes the box at column 50 unless the line is longer
+   size_t len = out.count() - start;
+   out.padLeft("=", len < 50 ? 50 - len : 0) << '\n';
+   out << "==================================================\n";
    //cout << " " <<setiosflags(ios::left) << setw(4) << getTypeStr() << resetiosflags(ios::left) << endl;
 }
 
 void
-CirGate::reportFanin(int level,int id) const
+CirGate::reportFanin(int level,int id,ostream& os) const
 {
+   TRACE_SPAN("FaninDFS");
    assert (level >= 0);
-   setGlobalref();
-   FaninDFS(id*2,level);
+   CirTravCtx& trav = CirTravCtx::forThread();
+   trav.begin(_cir->size());
+   MyOutBuf out(os);
+   FaninDFS(out,trav,id*2,level);
 }
 
 void
-CirGate::reportFanout(int level,int id) const
+CirGate::reportFanout(int level,int id,ostream& os) const
 {
+   TRACE_SPAN("FanoutDFS");
    assert (level >= 0);
-   setGlobalref();
-   FanoutDFS(id*2,level);
+   CirTravCtx& trav = CirTravCtx::forThread();
+   trav.begin(_cir->size());
+   MyOutBuf out(os);
+   FanoutDFS(out,trav,id*2,level);
 }
 
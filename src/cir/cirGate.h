@@ -9,11 +9,13 @@
 #ifndef CIR_GATE_H
 #define CIR_GATE_H
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
 #include "cirDef.h"
+#include "cirMgr.h"
 
 using namespace std;
 
@@ -22,112 +24,79 @@ class CirGate;
 //------------------------------------------------------------------------
 //   Define classes
 //------------------------------------------------------------------------
-// TODO: Define your own data members and member functions, or classes
-// Not yet remembering the lineNo.
-class CirGate {
+// Marks of one traversal at a time, owned by whoever traverses: an epoch
+// per gate id, so begin() unmarks everything in O(1) and traversals with
+// contexts of their own never touch the circuit, nor each other. Queries
+// that keep no context use the one of their thread; such traversals must
+// not nest.
+class CirTravCtx {
    public:
-    friend class CirMgr;
-    CirGate() : _ref(0), _lineNo(0), _fanin(0) {}
-    virtual ~CirGate() { delete[] _fanin; }
+    CirTravCtx() : _epoch(0) {}
+
+    // start a traversal of a circuit of n gate ids; nothing is marked
+    void begin(size_t n) {
+        if (_mark.size() < n) _mark.resize(n, 0);
+        if (++_epoch == 0) {  // wrapped; old marks could match again
+            fill(_mark.begin(), _mark.end(), 0);
+            _epoch = 1;
+        }
+    }
+    bool isMarked(unsigned id) const { return _mark[id] == _epoch; }
+    void mark(unsigned id) { _mark[id] = _epoch; }
 
-    // Basic access methods
-    // string getTypeStr() const { return ""; }
-    virtual string getTypeStr() const = 0;
-    virtual GateType getType() const = 0;
-    unsigned getLineNo() const { return _lineNo; }
-    void setLineNo(unsigned n) { _lineNo = n; }
-    unsigned* getFanin() const { return _fanin; }
-    unsigned* getFanin() { return _fanin; }
-    vector<unsigned>& getFanout() { return _fanout; }
-    static void setGlobalref() { _globalref++; }
-    bool isGlobalref() const { return (_globalref == _ref); }
-    void setRefToGlobalRef() const { _ref = _globalref; }
-
-    // Printing functions
-    virtual void printGate() const = 0;
-    //add gateId for report gate
-    void reportGate(int id) const;
-    void reportFanin(int level,int id) const;
-    void reportFanout(int level,int id) const;
+    static CirTravCtx &forThread();
 
    private:
-    void FaninDFS(int,unsigned,unsigned) const;
-    void FanoutDFS(int,unsigned,unsigned) const;
-   protected:
-    // using literal
-    vector<unsigned> _fanout;
-    unsigned* _fanin;
-    unsigned _lineNo;
-    mutable unsigned _ref;
-    static unsigned _globalref;
+    IdList _mark;
+    unsigned _epoch;
 };
-class SymbolGate : public CirGate {
-   public:
-    SymbolGate() : CirGate(), _symbol(0) {}
-    virtual ~SymbolGate() { delete[] _symbol; }
-    void setSymbol(const string& s) {
-        _symbol = new char[s.size() + 1]();
-        strcpy(_symbol, s.c_str());
-    }
-    const char* getSymbol() const { return _symbol; }
 
-   private:
-    char* _symbol;
-};
-class InputGate : public SymbolGate {
+// A gate is not an object of its own. All gate data lives in the
+// structure-of-arrays store of CirMgr::ParsedCir, and CirGate is a
+// (circuit, id) handle that reads those arrays. A default-constructed
+// CirGate refers to no gate and tests false.
+class CirGate {
    public:
-    InputGate() : SymbolGate() {}
-    string getTypeStr() const { return "PI"; }
-    GateType getType() const { return PI_GATE; }
-    void printGate() const { cout << getTypeStr(); }
+    friend class CirMgr;
+    CirGate() : _cir(0), _id(0) {}
+    CirGate(const CirMgr::ParsedCir* cir, unsigned id) : _cir(cir), _id(id) {}
 
-   private:
-    // using literal
-};
-class OutputGate : public SymbolGate {
-   public:
-    OutputGate(unsigned in) : SymbolGate() { _fanin = new unsigned(in); }
-    string getTypeStr() const { return "PO"; }
-    GateType getType() const { return PO_GATE; }
-    void printGate() const { cout << getTypeStr(); }
+    explicit operator bool() const { return _cir != 0; }
 
-   private:
-    // using literal
-};
-class AndGate : public CirGate {
-   public:
-    AndGate() : CirGate() {}
-    AndGate(unsigned fan1, unsigned fan2) : CirGate() {
-        _fanin = new unsigned[2];
-        _fanin[0] = fan1;
-        _fanin[1] = fan2;
+    // Basic access methods
+    unsigned getId() const { return _id; }
+    string getTypeStr() const;
+    GateType getType() const { return GateType(_cir->type[_id]); }
+    unsigned getLineNo() const { return _cir->lineNo[_id]; }
+    const unsigned* getFanin() const { return _cir->fanin + 2 * _id; }
+    const unsigned* getFanout() const {
+        return _cir->fanoutLit + _cir->fanoutOfs[_id];
     }
-    void printGate() const { cout << getTypeStr(); }
-    string getTypeStr() const { return "AIG"; }
-    GateType getType() const { return AIG_GATE; }
+    unsigned getFanoutNum() const { return _cir->getFanoutNum(_id); }
+    const char* getSymbol() const { return _cir->getSymbol(_id); }
 
-   private:
-    // using literal
-};
-class ConstGate : public CirGate {
-   public:
-    ConstGate() : CirGate() {}
+    // Printing functions
     void printGate() const { cout << getTypeStr(); }
-    string getTypeStr() const { return "CONST"; }
-    GateType getType() const { return CONST_GATE; }
+    //add gateId for report gate
+    void reportGate(int id) const;
+    // safe to run from several threads at once, as is any const query
+    // of CirMgr, as long as nothing modifies the circuit meanwhile
+    void reportFanin(int level,int id,ostream& os = cout) const;
+    void reportFanout(int level,int id,ostream& os = cout) const;
 
    private:
-    // using literal
-};
+    void FaninDFS(MyOutBuf&,CirTravCtx&,int,unsigned,unsigned) const;
+    void FanoutDFS(MyOutBuf&,CirTravCtx&,int,unsigned,unsigned) const;
 
-class UndefGate : public CirGate {
-   public:
-    UndefGate() : CirGate() {}
-    void printGate() const { cout << getTypeStr(); }
-    string getTypeStr() const { return "UNDEF"; }
-    GateType getType() const { return UNDEF_GATE; }
-
-   private:
+    const CirMgr::ParsedCir* _cir;
+    unsigned _id;
 };
 
+// return a null gate if "gid" corresponds to no gate.
+inline CirGate CirMgr::getGate(unsigned gid) const {
+    return (gid < Circuit.size() && Circuit.exists(gid))
+               ? CirGate(&Circuit, gid)
+               : CirGate();
+}
+
 #endif  // CIR_GATE_H
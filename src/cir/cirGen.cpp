@@ -0,0 +1,110 @@
+/****************************************************************************
+  FileName     [ cirGen.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the synthetic AIG generator ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "cirMgr.h"
+#include "myOutBuf.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// hubs are the first HUB_SIZE usable gates of a level
+enum {
+    HUB_SIZE = 8
+};
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// uniform in [0, n); RandomNumGen may return n itself
+static size_t pick(const RandomNumGen &rn, size_t n) {
+    size_t k = rn(int(n));
+    return k < n ? k : n - 1;
+}
+static bool percent(const RandomNumGen &rn, unsigned pct) {
+    return pct != 0 && pick(rn, 100) < pct;
+}
+
+/******************************************************/
+/*   Public member functions about circuit generation  */
+/******************************************************/
+// The ANDs are cut into p.depth levels of nearly equal size; level 0 is
+// the PIs. Ids are handed out level by level, so every level is an id
+// range and nothing but the level bounds is kept, whatever the size.
+// The last p.floatPct percent of every AND level are never used as a
+// fanin, and the undefined gates take the ids after the last AND.
+//
+// An AND's first fanin comes from the level just below, which fixes the
+// depth; the level's ANDs take the usable gates there in turn, from a
+// random start, so each of them gets a fanout. The second fanin is an
+// undefined gate with p.undefPct percent probability, else one of the
+// hubs of a random lower level with p.hubPct percent, else any usable
+// gate of a random lower level. Hubs get a large fanout, the other gates
+// about the average one. The POs take the usable gates of the top level
+// in turn, then random ones; the top-level gates left over have no
+// fanout. Every fanin is inverted with probability 1/2.
+void CirMgr::genAag(ostream &outfile, const GenParam &p) {
+    TRACE_SPAN("genAag");
+    const RandomNumGen rn(p.seed);
+    const size_t depth = max<size_t>(1, min(p.depth, p.ands));
+    const size_t undefs = (p.ands * p.undefPct + 99) / 100;
+    // first id and number of usable gates per level
+    vector<size_t> first(depth + 2), usable(depth + 1);
+    first[0] = 1;
+    usable[0] = p.inputs;
+    first[1] = p.inputs + 1;
+    for (size_t l = 1; l <= depth; l++) {
+        size_t n = p.ands / depth + (l <= p.ands % depth);
+        first[l + 1] = first[l] + n;
+        usable[l] = n - n * p.floatPct / 100;
+        if (usable[l] == 0 && n != 0) usable[l] = 1;
+    }
+    const size_t maxid = p.inputs + p.ands + undefs;
+    // a random usable gate of a level below l, as a literal
+    auto lowerLit = [&](size_t l, bool hub) -> size_t {
+        size_t k = pick(rn, l);
+        while (usable[k] == 0) k--;
+        size_t n = hub ? min<size_t>(usable[k], HUB_SIZE) : usable[k];
+        return (first[k] + pick(rn, n)) * 2 + pick(rn, 2);
+    };
+
+    MyOutBuf out(outfile);
+    out << "aag " << maxid << ' ' << p.inputs << " 0 " << p.outputs << ' '
+        << p.ands << '\n';
+    for (size_t i = 1; i <= p.inputs; i++) out << i * 2 << '\n';
+    size_t top = depth, next = 0;
+    while (top > 0 && usable[top] == 0) top--;
+    for (size_t o = 0; o < p.outputs; o++) {
+        if (next < usable[top])
+            out << (first[top] + next++) * 2 + pick(rn, 2) << '\n';
+        else
+            out << lowerLit(depth + 1, false) << '\n';
+    }
+    for (size_t l = 1; l <= depth; l++) {
+        size_t k = l - 1;
+        while (usable[k] == 0) k--;
+        const size_t rot = pick(rn, usable[k]);
+        for (size_t id = first[l]; id < first[l + 1]; id++) {
+            size_t f0 = (first[k] + (id - first[l] + rot) % usable[k]) * 2 +
+                        pick(rn, 2);
+            size_t f1;
+            if (percent(rn, p.undefPct))
+                f1 = (p.inputs + p.ands + 1 + pick(rn, undefs)) * 2 +
+                     pick(rn, 2);
+            else
+                f1 = lowerLit(l, percent(rn, p.hubPct));
+            out << id * 2 << ' ' << f0 << ' ' << f1 << '\n';
+        }
+    }
+    out << "c\nAAG generated by CIRGENerate\n";
+}
@@ -8,14 +8,22 @@
 
 #include "cirMgr.h"
 #include <ctype.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <regex>
 #include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "cirGate.h"
+#include "myOutBuf.h"
+#include "myThreadPool.h"
 #include "util.h"
 
 using namespace std;
@@ -23,6 +31,16 @@ typedef stringstream ss;
 
 // TODO: Implement memeber functions for class CirMgr
 
+void CirMgr::ParsedCir::allocGates() {
+    size_t n = size();
+    PI_list = arena.allocZero<unsigned>(inputs);
+    type = arena.alloc<unsigned char>(n);
+    memset(type, TOT_GATE, n);
+    fanin = arena.allocZero<unsigned>(n * 2);
+    lineNo = arena.allocZero<unsigned>(n);
+    symbol = arena.allocZero<char *>(inputs + outputs);
+}
+
 /*******************************/
 /*   Global variable and enum  */
 /*******************************/
@@ -34,17 +52,9 @@ enum CirParseError {
     ILLEGAL_WSPACE,
     ILLEGAL_NUM,
     ILLEGAL_IDENTIFIER,
-    ILLEGAL_SYMBOL_TYPE,
-    ILLEGAL_SYMBOL_NAME,
     MISSING_NUM,
     MISSING_IDENTIFIER,
     MISSING_NEWLINE,
-    MISSING_DEF,
-    CANNOT_INVERTED,
-    MAX_LIT_ID,
-    REDEF_GATE,
-    REDEF_SYMBOLIC_NAME,
-    REDEF_CONST,
     NUM_TOO_SMALL,
     NUM_TOO_BIG,
 
@@ -56,10 +66,8 @@ enum CirParseError {
 /**************************************/
 static unsigned lineNo = 0;  // in printint, lineNo needs to ++
 static unsigned colNo = 0;   // in printing, colNo needs to ++
-static char buf[1024];
 static string errMsg;
 static int errInt;
-static CirGate *errGate;
 
 static bool parseError(CirParseError err) {
     switch (err) {
@@ -84,15 +92,6 @@ static bool parseError(CirParseError err) {
             cerr << "[ERROR] Line " << lineNo + 1 << ": Illegal identifier \""
                  << errMsg << "\"!!" << endl;
             break;
-        case ILLEGAL_SYMBOL_TYPE:
-            cerr << "[ERROR] Line " << lineNo + 1 << ", Col " << colNo + 1
-                 << ": Illegal symbol type (" << errMsg << ")!!" << endl;
-            break;
-        case ILLEGAL_SYMBOL_NAME:
-            cerr << "[ERROR] Line " << lineNo + 1 << ", Col " << colNo + 1
-                 << ": Symbolic name contains un-printable char(" << errInt
-                 << ")!!" << endl;
-            break;
         case MISSING_NUM:
             cerr << "[ERROR] Line " << lineNo + 1 << ", Col " << colNo + 1
                  << ": Missing " << errMsg << "!!" << endl;
@@ -105,34 +104,6 @@ static bool parseError(CirParseError err) {
             cerr << "[ERROR] Line " << lineNo + 1 << ", Col " << colNo + 1
                  << ": A new line is expected here!!" << endl;
             break;
-        case MISSING_DEF:
-            cerr << "[ERROR] Line " << lineNo + 1 << ": Missing " << errMsg
-                 << " definition!!" << endl;
-            break;
-        case CANNOT_INVERTED:
-            cerr << "[ERROR] Line " << lineNo + 1 << ", Col " << colNo + 1
-                 << ": " << errMsg << " " << errInt << "(" << errInt / 2
-                 << ") cannot be inverted!!" << endl;
-            break;
-        case MAX_LIT_ID:
-            cerr << "[ERROR] Line " << lineNo + 1 << ", Col " << colNo + 1
-                 << ": Literal \"" << errInt << "\" exceeds maximum valid ID!!"
-                 << endl;
-            break;
-        case REDEF_GATE:
-            cerr << "[ERROR] Line " << lineNo + 1 << ": Literal \"" << errInt
-                 << "\" is redefined, previously defined as "
-                 << errGate->getTypeStr() << " in line " << errGate->getLineNo()
-                 << "!!" << endl;
-            break;
-        case REDEF_SYMBOLIC_NAME:
-            cerr << "[ERROR] Line " << lineNo + 1 << ": Symbolic name for \""
-                 << errMsg << errInt << "\" is redefined!!" << endl;
-            break;
-        case REDEF_CONST:
-            cerr << "[ERROR] Line " << lineNo + 1 << ", Col " << colNo + 1
-                 << ": Cannot redefine constant (" << errInt << ")!!" << endl;
-            break;
         case NUM_TOO_SMALL:
             cerr << "[ERROR] Line " << lineNo + 1 << ": " << errMsg
                  << " is too small (" << errInt << ")!!" << endl;
@@ -147,245 +118,564 @@ static bool parseError(CirParseError err) {
     return false;
 }
 
+// true if s[from..] is a non-empty run of decimal digits
+static bool isDigits(const string &s, size_t from) {
+    if (s.size() <= from) return false;
+    for (size_t i = from; i < s.size(); i++)
+        if (!isdigit(s[i])) return false;
+    return true;
+}
+
+// Parse a decimal number at p and advance p past it.
+// Return false if no digit is there or the value overflows unsigned.
+static bool parseNum(const char *&p, const char *e, unsigned &num) {
+    const char *b = p;
+    unsigned long long n = 0;
+    while (p < e && *p >= '0' && *p <= '9') {
+        n = n * 10 + unsigned(*p++ - '0');
+        if (n > 0xffffffffULL) return false;
+    }
+    num = unsigned(n);
+    return p != b;
+}
+
+// [b, e) must be exactly "<num>"
+static bool parseNumLine(const char *b, const char *e, unsigned &num) {
+    return parseNum(b, e, num) && b == e;
+}
+
+// [b, e) must be exactly "<num> <num> ... <num>" with n numbers
+static bool parseNumLine(const char *b, const char *e, unsigned *num,
+                         size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (i != 0 && (b == e || *b++ != ' ')) return false;
+        if (!parseNum(b, e, num[i])) return false;
+    }
+    return b == e;
+}
+
+//------------------------------------------------------------------------
+//   class CirReadBuf : whole design file mapped into memory
+//------------------------------------------------------------------------
+// Lines are handed out as [begin, end) ranges into the mapped file, so the
+// parser never copies or allocates per line.
+class CirReadBuf {
+   public:
+    CirReadBuf()
+        : _data(0), _cur(0), _end(0), _size(0), _mapped(false),
+          _binary(false) {}
+    // non-owning view of [b, e) inside another buffer
+    CirReadBuf(const char *b, const char *e)
+        : _data(0), _cur(b), _end(e), _size(0), _mapped(false),
+          _binary(false) {}
+    ~CirReadBuf() { close(); }
+
+    bool open(const string &fileName) {
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        _size = st.st_size;
+        if (_size != 0) {
+            void *p = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, _size, MADV_SEQUENTIAL);
+                _data = (const char *)p;
+                _mapped = true;
+            } else
+                readAll(fd);
+        }
+        ::close(fd);
+        _cur = _data;
+        _end = _data + _size;
+        return true;
+    }
+    void close() {
+        if (_mapped)
+            munmap(const_cast<char *>(_data), _size);
+        else
+            delete[] _data;
+        _data = _cur = _end = 0;
+        _size = 0;
+        _mapped = false;
+        _binary = false;
+    }
+    // Same contract as getline(): false only when nothing is left
+    bool getLine(const char *&b, const char *&e) {
+        if (_cur >= _end) return false;
+        b = _cur;
+        e = (const char *)memchr(_cur, '\n', _end - _cur);
+        if (e == 0) e = _end;
+        _cur = (e == _end) ? _end : e + 1;
+        return true;
+    }
+    // One LEB128-style varint of the binary AND section
+    bool getDelta(unsigned &x) {
+        x = 0;
+        for (unsigned sh = 0; sh < 32; sh += 7) {
+            if (_cur >= _end) return false;
+            unsigned char ch = *_cur++;
+            x |= unsigned(ch & 0x7f) << sh;
+            if (!(ch & 0x80)) return true;
+        }
+        return false;
+    }
+    const char *pos() const { return _cur; }
+    const char *end() const { return _end; }
+    // continue reading at p, a position inside the buffer
+    void seek(const char *p) { _cur = p; }
+    // "aig" header: inputs are implicit and ANDs are delta encoded
+    void setBinary(bool b) { _binary = b; }
+    bool isBinary() const { return _binary; }
+
+   private:
+    // fallback for files that cannot be mapped (e.g. pipes)
+    void readAll(int fd) {
+        char *buf = new char[_size];
+        size_t got = 0;
+        while (got < _size) {
+            ssize_t n = ::read(fd, buf + got, _size - got);
+            if (n <= 0) break;
+            got += n;
+        }
+        _data = buf;
+        _size = got;
+    }
+
+    const char *_data;
+    const char *_cur;
+    const char *_end;
+    size_t _size;
+    bool _mapped;
+    bool _binary;
+};
+
 /**************************************************************/
 /*   class CirMgr member functions for circuit construction   */
 /**************************************************************/
+// Report why the header line errstr is not "aag M I L O A" (or "aig"):
+// single spaces between the fields and five decimal numbers.
 void CirMgr::HeaderError(string &errstr) {
+    static const char *const nums[] = {"number of variables", "number of PIs",
+                                       "number of latches", "number of POs",
+                                       "number of AIGs"};
     colNo = 0;
-    //space
+    if (errstr.empty()) {
+        errMsg = "aag";
+        parseError(MISSING_IDENTIFIER);
+        return;
+    }
     if (errstr[0] == ' ') {
         parseError(EXTRA_SPACE);
         return;
     }
-    //illegal space
     if (isspace(errstr[0])) {
         errInt = int(errstr[0]);
         parseError(ILLEGAL_WSPACE);
         return;
     }
-    string parsebuf = "";
-    while(!isspace(errstr[colNo]) && colNo < errstr.size()){
-        colNo++;
-        parsebuf += errstr[colNo];
-    }
-    //aag[num]
-    if(regex_match(parsebuf,regex("aag[0-9]+"))){
+    string tok;
+    while (colNo < errstr.size() && !isspace(errstr[colNo]))
+        tok += errstr[colNo++];
+    // aag[num]
+    if ((tok.compare(0, 3, "aag") == 0 || tok.compare(0, 3, "aig") == 0) &&
+        isDigits(tok, 3)) {
+        colNo = 3;
         parseError(MISSING_SPACE);
         return;
     }
-    //aag!#$%^&
-    if(!regex_match(parsebuf,regex("aag"))){
-        errMsg = parsebuf;
+    if (tok != "aag" && tok != "aig") {
+        errMsg = tok;
         parseError(ILLEGAL_IDENTIFIER);
         return;
     }
-    //aag\n
-    if(colNo == errstr.size()){
-        colNo++;
-        errMsg = "number of variables";
-        parseError(MISSING_NUM);
-        return;
-    }
-    parsebuf = "";
-    //aag\t
-    if(errstr[colNo] != ' ' && isspace(errstr[colNo])){
-        errInt = int(errstr[colNo]);
-        parseError(ILLEGAL_WSPACE);
-        return;
-    }
-    parsebuf += errstr[++colNo];
-    //aag[space]\n
-    if(colNo == errstr.size()){
-        errMsg = "number of variables";
-        parseError(MISSING_NUM);
-    }
-    //aag[space][space]
-    if(errstr[colNo] == ' '){
-        parseError(EXTRA_SPACE);
-        return;
-    }
-    //aag[space]\t
-    if(isspace(errstr[colNo])){
-        errInt  = int(errstr[colNo]);
-        parseError(ILLEGAL_WSPACE);
-        return;
-    }
-    while(!isspace(errstr[colNo]) &&  colNo < errstr.size()) {
-        colNo++;
-        parsebuf += errstr[colNo];
-    }
-    //aag[space]!@#$%%
-    if(!regex_match(parsebuf,regex("[0-9]+"))){
-        errMsg = "number of variables(" + parsebuf + ")";
-        parseError(ILLEGAL_NUM);
-        return;
-    }
-    parsebuf = "";
-    //aag[space][num]\n
-    if(colNo == errstr.size()){
-        colNo++;
-        errMsg = "number of PIs";
-        parseError(MISSING_NUM);
-        return;
-    }
-    //aag[space][num]\t
-     if(errstr[colNo] != ' ' && isspace(errstr[colNo])){
-        errInt = int(errstr[colNo]);
-        parseError(ILLEGAL_WSPACE);
-        return;
-    }
-    parsebuf += errstr[++colNo];
-    //aag[space][num][space]\n
-    if(colNo == errstr.size()){
-        errMsg = "number of PIs";
-        parseError(MISSING_NUM);
-    }
-    //aag[space][num][space][space]
-    if(errstr[colNo] == ' '){
-        parseError(EXTRA_SPACE);
-        return;
+    for (size_t i = 0; i < 5; i++) {
+        // a single space, then the number
+        if (colNo == errstr.size() ||
+            (errstr[colNo] == ' ' && ++colNo == errstr.size())) {
+            errMsg = nums[i];
+            parseError(MISSING_NUM);
+            return;
+        }
+        if (errstr[colNo] == ' ') {
+            parseError(EXTRA_SPACE);
+            return;
+        }
+        if (isspace(errstr[colNo])) {
+            errInt = int(errstr[colNo]);
+            parseError(ILLEGAL_WSPACE);
+            return;
+        }
+        tok.clear();
+        while (colNo < errstr.size() && !isspace(errstr[colNo]))
+            tok += errstr[colNo++];
+        if (!isDigits(tok, 0)) {
+            errMsg = string(nums[i]) + "(" + tok + ")";
+            parseError(ILLEGAL_NUM);
+            return;
+        }
     }
-    //aag[space][num][space]\t
-    if(isspace(errstr[colNo])){
-        errInt  = int(errstr[colNo]);
-        parseError(ILLEGAL_WSPACE);
+    if (colNo < errstr.size()) {
+        parseError(MISSING_NEWLINE);
         return;
     }
-
-    
-
-
+    // all fields are there, so a number does not fit
+    errMsg = "header";
+    parseError(ILLEGAL_NUM);
 }
-bool CirMgr::ParseHeader(ifstream &aagf) {
-    smatch tok;
-    regex aagheader("aag ([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+) ([0-9]+)");
-    string header;
-    if (!getline(aagf, header)) {
+bool CirMgr::ParseHeader(CirReadBuf &aagf) {
+    TRACE_SPAN("ParseHeader");
+    const char *b, *e;
+    if (!aagf.getLine(b, e)) {
         return false;
     }
-    if (!regex_match(header, tok, aagheader)) {
-        // need to remove later
+    unsigned n[5];
+    bool binary = (e - b >= 4 && memcmp(b, "aig ", 4) == 0);
+    if (e - b < 4 || (!binary && memcmp(b, "aag ", 4) != 0) ||
+        !parseNumLine(b + 4, e, n, 5)) {
+        string header(b, e);
         HeaderError(header);
         return false;
     }
+    Circuit.maxid = n[0];
+    Circuit.inputs = n[1];
+    Circuit.latches = n[2];
+    Circuit.outputs = n[3];
+    Circuit.ands = n[4];
+    if (binary) {
+        // binary AIGER numbers its variables as inputs, latches, then ANDs
+        if (Circuit.latches != 0) {
+            errMsg = "Number of latches";
+            errInt = Circuit.latches;
+            return parseError(NUM_TOO_BIG);
+        }
+        if (Circuit.maxid != Circuit.inputs + Circuit.ands) {
+            errMsg = "Number of variables";
+            errInt = Circuit.maxid;
+            return parseError(Circuit.maxid < Circuit.inputs + Circuit.ands
+                                  ? NUM_TOO_SMALL
+                                  : NUM_TOO_BIG);
+        }
+        aagf.setBinary(true);
+    }
     lineNo++;
-    ss tmp;
-    for (size_t i = 0; i < 5; i++) {
-        // cerr << tok[i].str() << endl;
-        tmp << tok[i + 1].str() << " ";
-    }
-    tmp >> Circuit.maxid;
-    tmp >> Circuit.inputs;
-    tmp >> Circuit.latches;
-    tmp >> Circuit.outputs;
-    tmp >> Circuit.ands;
     // one for const 0
-    Circuit.id2Gate = new CirGate *[Circuit.maxid + Circuit.outputs + 1]();
+    Circuit.allocGates();
     return true;
 }
-bool CirMgr::GenGates(ifstream &aagf) {
-    regex gateformat("([0-9]+)");
-    smatch tok;
-    string gate;
-    int lit = 0;
+bool CirMgr::GenGates(CirReadBuf &aagf, unsigned nThreads) {
+    TRACE_SPAN("GenGates");
+    const char *b, *e;
+    unsigned lit = 0;
     // Gen constant 0
-    Circuit.id2Gate[0] = new ConstGate;
+    Circuit.type[0] = CONST_GATE;
     // input
-    Circuit.PI_list = new unsigned[Circuit.inputs]();
     for (size_t i = 0; i < Circuit.inputs; i++) {
-        if (!getline(aagf, gate)) return false;
-        if (!regex_match(gate, tok, gateformat)) return false;
-        lineNo++;
-        myStr2Int(tok[1], lit);
-        Circuit.id2Gate[lit / 2] = new InputGate;
-        Circuit.id2Gate[lit / 2]->setLineNo(i + 2);
+        if (aagf.isBinary())
+            lit = 2 * (i + 1);
+        else {
+            if (!aagf.getLine(b, e)) return false;
+            if (!parseNumLine(b, e, lit)) return false;
+            if (lit / 2 > Circuit.maxid) return false;
+            lineNo++;
+        }
+        Circuit.type[lit / 2] = PI_GATE;
+        Circuit.fanin[lit / 2 * 2] = i;
+        Circuit.lineNo[lit / 2] = i + 2;
         Circuit.PI_list[i] = lit / 2;
     }
     // outputs
     for (size_t i = 0; i < Circuit.outputs; i++) {
-        if (!getline(aagf, gate)) return false;
-        if (!regex_match(gate, tok, gateformat)) return false;
+        if (!aagf.getLine(b, e)) return false;
+        if (!parseNumLine(b, e, lit)) return false;
+        if (lit / 2 > Circuit.maxid) return false;
         lineNo++;
-        myStr2Int(tok[1], lit);
-        Circuit.id2Gate[Circuit.maxid + 1 + i] = new OutputGate(lit);
-        Circuit.id2Gate[Circuit.maxid + 1 + i]->setLineNo(i + 2 +
-                                                          Circuit.inputs);
+        size_t id = Circuit.maxid + 1 + i;
+        Circuit.type[id] = PO_GATE;
+        Circuit.fanin[id * 2] = lit;
+        Circuit.lineNo[id] = i + 2 + Circuit.inputs;
     }
     // AIG
-    regex Andformat("([0-9]+) ([0-9]+) ([0-9]+)");
-    for (size_t i = 0; i < Circuit.ands; i++) {
-        // haven't add symbol parsing
-        if (!getline(aagf, gate)) return false;
-        if (!regex_match(gate, tok, Andformat)) return false;
-        lineNo++;
-        int lit[3];
-        for (size_t j = 0; j < 3; j++) {
-            myStr2Int(tok[j + 1].str(), lit[j]);
+    if (nThreads > 1 && !aagf.isBinary() && Circuit.ands >= nThreads) {
+        if (!GenAndGates(aagf, nThreads)) return false;
+    } else for (size_t i = 0; i < Circuit.ands; i++) {
+        unsigned lit[3];
+        if (aagf.isBinary()) {
+            // lhs is implicit; rhs0 = lhs - delta0, rhs1 = rhs0 - delta1
+            unsigned d0, d1;
+            lit[0] = 2 * (Circuit.inputs + i + 1);
+            if (!aagf.getDelta(d0) || !aagf.getDelta(d1)) return false;
+            // d0 == 0 would make the AND its own fanin
+            if (d0 == 0 || d0 > lit[0] || d1 > lit[0] - d0) {
+                ostringstream os;
+                os << (d0 == 0 || d0 > lit[0] ? "Delta0" : "Delta1")
+                   << " of AND gate " << lit[0] / 2;
+                errMsg = os.str();
+                errInt = d0 == 0 || d0 > lit[0] ? d0 : d1;
+                return parseError(d0 == 0 ? NUM_TOO_SMALL : NUM_TOO_BIG);
+            }
+            lit[1] = lit[0] - d0;
+            lit[2] = lit[1] - d1;
+        } else {
+            if (!aagf.getLine(b, e)) return false;
+            if (!parseNumLine(b, e, lit, 3)) return false;
+            lineNo++;
+        }
+        if (!defineAnd(lit, i)) return false;
+    }
+    // symbols: ([io])([0-9]+) ([^\n\r]+)
+    while (aagf.getLine(b, e)) {
+        if (e - b == 1 && *b == 'c') break;
+        if (b == e || (*b != 'i' && *b != 'o')) return false;
+        const char *p = b + 1;
+        unsigned pos = 0;
+        if (!parseNum(p, e, pos)) return false;
+        if (p == e || *p++ != ' ' || p == e) return false;
+        if (memchr(p, '\r', e - p) != 0) return false;
+        if (*b == 'i') {
+            if (pos >= Circuit.inputs) {
+                errMsg = "PI index";
+                errInt = pos;
+                return parseError(NUM_TOO_BIG);
+            }
+            Circuit.setSymbol(pos, p, e - p);
+        } else {
+            if (pos >= Circuit.outputs) {
+                errMsg = "PO index";
+                errInt = pos;
+                return parseError(NUM_TOO_BIG);
+            }
+            Circuit.setSymbol(Circuit.inputs + pos, p, e - p);
         }
-        Circuit.id2Gate[lit[0] / 2] = new AndGate(lit[1], lit[2]);
-        Circuit.id2Gate[lit[0] / 2]->setLineNo(i + 2 + Circuit.outputs +
-                                               Circuit.inputs);
+        lineNo++;
     }
-    // symbols
+    return true;
+}
+// The i-th AND of the file, lit = lhs, rhs0, rhs1; false if a literal is
+// out of range.
+inline bool CirMgr::defineAnd(const unsigned *lit, size_t i) {
+    if (lit[0] / 2 > Circuit.maxid || lit[1] / 2 > Circuit.maxid ||
+        lit[2] / 2 > Circuit.maxid)
+        return false;
+    Circuit.type[lit[0] / 2] = AIG_GATE;
+    Circuit.fanin[lit[0] / 2 * 2] = lit[1];
+    Circuit.fanin[lit[0] / 2 * 2 + 1] = lit[2];
+    Circuit.lineNo[lit[0] / 2] = i + 2 + Circuit.outputs + Circuit.inputs;
+    return true;
+}
+// ASCII AND section read by nThreads at once.  The rest of the file is
+// cut into nThreads byte ranges, each starting after a '\n'.  The threads
+// first count the lines of their range, which gives every range the index
+// of its first line, and then parse the AND lines among them straight
+// into the gate arrays; no line is scanned by the main thread and nothing
+// is copied.  A thread claims a gate id before writing it, so no gate is
+// written twice.  If an lhs repeats (invalid AIGER, but the serial reader
+// lets the last line win), the section is read again in order once the
+// threads are done, and the result always equals the serial reader.
+bool CirMgr::GenAndGates(CirReadBuf &aagf, unsigned nThreads) {
+    TRACE_SPAN("GenAndGates");
+    MyThreadPool pool(nThreads);
+    nThreads = pool.size();
+    const char *const begin = aagf.pos(), *const end = aagf.end();
+    vector<const char *> cut(nThreads + 1, end);
+    cut[0] = begin;
+    for (unsigned t = 1; t < nThreads; t++) {
+        const char *p = max(cut[t - 1], begin + (end - begin) * t / nThreads);
+        if (p != begin && p != end && p[-1] != '\n') {
+            const char *nl = (const char *)memchr(p, '\n', end - p);
+            p = (nl == 0) ? end : nl + 1;
+        }
+        cut[t] = p;
+    }
+    // lines per range, then the index of the first line of every range
+    vector<size_t> first(nThreads + 1, 0);
+    pool.run([&](unsigned t) {
+        size_t n = 0;
+        for (const char *p = cut[t]; p < cut[t + 1]; n++) {
+            const char *nl = (const char *)memchr(p, '\n', cut[t + 1] - p);
+            p = (nl == 0) ? cut[t + 1] : nl + 1;
+        }
+        first[t + 1] = n;
+    });
+    for (unsigned t = 0; t < nThreads; t++) first[t + 1] += first[t];
+    const size_t ands = Circuit.ands;
+    if (first[nThreads] < ands) return false;
 
-    regex Symbolformat("([io])([0-9]+) ([^\n\r]+)");
-    while (getline(aagf, gate)) {
-        if (gate == "c") break;
-        if (!regex_match(gate, tok, Symbolformat)) return false;
-        lineNo++;
-        if (tok[1] == "i") {
-            int inputid = 0;
-            myStr2Int(tok[2], inputid);
-            InputGate *i =
-                (InputGate *)Circuit.id2Gate[Circuit.PI_list[inputid]];
-            i->setSymbol(tok[3].str());
-        } else if (tok[1] == "o") {
-            int outputid = 0;
-            myStr2Int(tok[2], outputid);
-            OutputGate *o =
-                (OutputGate *)Circuit.id2Gate[Circuit.maxid + outputid + 1];
-            o->setSymbol(tok[3].str());
+    vector<char> ok(nThreads, 1);
+    vector<atomic<bool> > claimed(Circuit.maxid + 1);
+    atomic<bool> repeated(false);
+    const char *andEnd = end;  // set by the range holding the last AND
+    pool.run([&](unsigned t) {
+        if (first[t] >= ands) return;
+        CirReadBuf chunk(cut[t], cut[t + 1]);
+        const size_t last = min(first[t + 1], ands);
+        const char *b, *e;
+        unsigned lit[3];
+        for (size_t i = first[t]; i < last; i++) {
+            if (!chunk.getLine(b, e) || !parseNumLine(b, e, lit, 3) ||
+                lit[0] / 2 > Circuit.maxid) {
+                ok[t] = 0;
+                return;
+            }
+            // relaxed is enough; pool.run() returns after every job
+            if (claimed[lit[0] / 2].exchange(true, memory_order_relaxed))
+                repeated.store(true, memory_order_relaxed);
+            else if (!defineAnd(lit, i)) {
+                ok[t] = 0;
+                return;
+            }
         }
-    }
+        if (last == ands) andEnd = chunk.pos();
+    });
+    for (unsigned t = 0; t < nThreads; t++)
+        if (!ok[t]) return false;
+
+    if (repeated) {
+        CirReadBuf again(begin, end);
+        const char *b, *e;
+        unsigned lit[3];
+        for (size_t i = 0; i < ands; i++)
+            if (!again.getLine(b, e) || !parseNumLine(b, e, lit, 3) ||
+                !defineAnd(lit, i))
+                return false;
+    }
+    aagf.seek(andEnd);
+    lineNo += ands;
     return true;
 }
-bool CirMgr::ConstructCir() {
-    for (size_t i = 0; i < Circuit.maxid + Circuit.outputs + 1; i++) {
-        if (Circuit.id2Gate[i] != 0) {
-            if (Circuit.id2Gate[i]->getType() == AIG_GATE) {
-                unsigned *f = Circuit.id2Gate[i]->getFanin();
-                // push literal in
-                if (Circuit.id2Gate[f[0] / 2] == 0)
-                    Circuit.id2Gate[f[0] / 2] = new UndefGate;
-                Circuit.id2Gate[f[0] / 2]->_fanout.push_back(i * 2 +
-                                                             (f[0] % 2));
-                if (Circuit.id2Gate[f[1] / 2] == 0)
-                    Circuit.id2Gate[f[1] / 2] = new UndefGate;
-                Circuit.id2Gate[f[1] / 2]->_fanout.push_back(i * 2 +
-                                                             (f[1] % 2));
+// Fanouts are stored in CSR form: the fanout literals of gate id are
+// fanoutLit[fanoutOfs[id] .. fanoutOfs[id + 1]).  ConstructCir counts the
+// fanouts of every gate first, turns the counts into offsets and then
+// fills the literal array, so a gate's fanouts are always listed in
+// increasing order of the fanout gate id.
+
+// Count one fanout of lit's gate; a fanin that was never defined becomes
+// an UNDEF gate.
+inline void CirMgr::countFanout(unsigned lit) {
+    if (!Circuit.exists(lit / 2)) Circuit.type[lit / 2] = UNDEF_GATE;
+    Circuit.fanoutOfs[lit / 2 + 1]++;
+}
+bool CirMgr::ConstructCir(unsigned nThreads) {
+    TRACE_SPAN("ConstructCir");
+    MEM_PHASE("construct");
+    invalidateDfsList();
+    delete[] Circuit.fanoutOfs;
+    delete[] Circuit.fanoutLit;
+    Circuit.fanoutOfs = new unsigned[Circuit.size() + 1]();
+    Circuit.fanoutLit = 0;
+    if (nThreads > 1) return ConstructCirParallel(nThreads);
+    const size_t n = Circuit.size();
+    unsigned *ofs = Circuit.fanoutOfs;
+    for (size_t i = 0; i < n; i++) {
+        const unsigned *f = Circuit.fanin + i * 2;
+        if (Circuit.type[i] == AIG_GATE) {
+            countFanout(f[0]);
+            countFanout(f[1]);
+        } else if (Circuit.type[i] == PO_GATE)
+            countFanout(f[0]);
+    }
+    for (size_t i = 0; i < n; i++) ofs[i + 1] += ofs[i];
+    Circuit.fanoutLit = new unsigned[ofs[n]];
+    // ofs[id] is used as the fill cursor of id and shifted back afterwards
+    for (size_t i = 0; i < n; i++) {
+        const unsigned *f = Circuit.fanin + i * 2;
+        if (Circuit.type[i] == AIG_GATE) {
+            // push literal in
+            Circuit.fanoutLit[ofs[f[0] / 2]++] = i * 2 + (f[0] % 2);
+            Circuit.fanoutLit[ofs[f[1] / 2]++] = i * 2 + (f[1] % 2);
+        } else if (Circuit.type[i] == PO_GATE)
+            Circuit.fanoutLit[ofs[f[0] / 2]++] = i * 2 + (f[0] % 2);
+    }
+    for (size_t i = n; i > 0; i--) ofs[i] = ofs[i - 1];
+    ofs[0] = 0;
+    return true;
+}
+// Fanouts in three phases.  Each thread first scans its own range of
+// source gates and buckets the id of every source by the threads owning
+// its fanin ids, once per owner.  Each thread then counts the fanins of
+// the buckets addressed to it that fall in its range and, once the
+// per-thread totals are known, fills its own slice of the CSR arrays in
+// source order, fanin 0 before fanin 1.  No gate is written by two
+// threads and the result equals the serial loop.  There are never more
+// threads than gates, and fewer if the system runs out of threads.
+bool CirMgr::ConstructCirParallel(unsigned nThreads) {
+    TRACE_SPAN("ConstructCirParallel");
+    typedef IdList Bucket;
+    const size_t n = Circuit.size();
+    MyThreadPool pool(min<size_t>(nThreads, n));
+    nThreads = pool.size();
+    const size_t span = (n + nThreads - 1) / nThreads;
+    unsigned *ofs = Circuit.fanoutOfs;
+    vector<vector<Bucket> > bucket(nThreads, vector<Bucket>(nThreads));
+    vector<size_t> total(nThreads + 1, 0);
+    pool.run([&](unsigned t) {
+        vector<Bucket> &out = bucket[t];
+        size_t end = min(n, (t + 1) * span);
+        for (size_t i = t * span; i < end; i++) {
+            const unsigned *f = Circuit.fanin + i * 2;
+            if (Circuit.type[i] == AIG_GATE) {
+                out[f[0] / 2 / span].push_back(i);
+                if (f[1] / 2 / span != f[0] / 2 / span)
+                    out[f[1] / 2 / span].push_back(i);
+            } else if (Circuit.type[i] == PO_GATE)
+                out[f[0] / 2 / span].push_back(i);
+        }
+    });
+
+    // ofs[id + 1] holds the count, then the end offset within the slice
+    pool.run([&](unsigned t) {
+        for (unsigned s = 0; s < nThreads; s++) {
+            const Bucket &in = bucket[s][t];
+            for (size_t i = 0; i < in.size(); i++) {
+                const unsigned *f = Circuit.fanin + in[i] * 2;
+                unsigned k = (Circuit.type[in[i]] == AIG_GATE) ? 2 : 1;
+                for (unsigned j = 0; j < k; j++)
+                    if (f[j] / 2 / span == t) countFanout(f[j]);
             }
-            if (Circuit.id2Gate[i]->getType() == PO_GATE) {
-                unsigned *f = Circuit.id2Gate[i]->getFanin();
-                if (Circuit.id2Gate[*f / 2] == 0)
-                    Circuit.id2Gate[*f / 2] = new UndefGate;
-                Circuit.id2Gate[*f / 2]->_fanout.push_back(i * 2 + (*f % 2));
+        }
+        size_t end = min(n, (t + 1) * span);
+        for (size_t i = t * span + 1; i < end; i++) ofs[i + 1] += ofs[i];
+        total[t + 1] = (t * span < end) ? ofs[end] : 0;
+    });
+    for (unsigned t = 0; t < nThreads; t++) total[t + 1] += total[t];
+    Circuit.fanoutLit = new unsigned[total[nThreads]];
+    pool.run([&](unsigned t) {
+        size_t begin = min(n, t * span), end = min(n, (t + 1) * span);
+        for (size_t i = begin; i < end; i++) ofs[i + 1] += total[t];
+        // fill cursors; ofs[begin] belongs to the previous slice
+        vector<unsigned> cur(end - begin);
+        for (size_t i = begin; i < end; i++)
+            cur[i - begin] = (i == begin) ? total[t] : ofs[i];
+        for (unsigned s = 0; s < nThreads; s++) {
+            const Bucket &in = bucket[s][t];
+            for (size_t i = 0; i < in.size(); i++) {
+                const unsigned *f = Circuit.fanin + in[i] * 2;
+                unsigned k = (Circuit.type[in[i]] == AIG_GATE) ? 2 : 1;
+                for (unsigned j = 0; j < k; j++)
+                    if (f[j] / 2 / span == t)
+                        Circuit.fanoutLit[cur[f[j] / 2 - begin]++] =
+                            in[i] * 2 + (f[j] % 2);
             }
         }
-    }
+    });
     return true;
 }
-bool CirMgr::readCircuit(const string &fileName) {
-    ifstream aagf(fileName);
-    // finished read in the buf
-    if (!aagf) {
+bool CirMgr::readCircuit(const string &fileName, unsigned nThreads) {
+    TRACE_SPAN("readCircuit");
+    MEM_PHASE("parse");
+    CirReadBuf aagf;
+    if (!aagf.open(fileName)) {
         cerr << "Cannot open design \"" << fileName << "\"!!" << endl;
-        aagf.close();
         return false;
     }
+    lineNo = colNo = 0;
     if (!ParseHeader(aagf)) return false;
-    if (!GenGates(aagf)) return false;
+    if (!GenGates(aagf, nThreads)) return false;
 
-    if (!ConstructCir()) return false;
+    if (!ConstructCir(nThreads)) return false;
     aagf.close();
     return true;
 }
@@ -403,198 +693,326 @@ Circuit Statistics
   Total      162
 *********************/
 void CirMgr::printSummary() const {
-    cout << endl << "Circuit Statistics" << endl
-         << "==================" << endl
-         << setw(4) << "PI" << setw(12) << Circuit.inputs << endl
-         << setw(4) << "PO" << setw(12) << Circuit.outputs << endl
-         << setw(5) << "AIG" << setw(11) << Circuit.ands << endl
-         << "------------------" << endl
-         << setw(7) << "Total" << setw(9)
-         << Circuit.inputs + Circuit.outputs + Circuit.ands << endl;
-    return;
+    MyOutBuf out(cout);
+    out << "\nCircuit Statistics\n"
+        << "==================\n";
+    out.padLeft("PI", 4).padLeft(Circuit.inputs, 12) << '\n';
+    out.padLeft("PO", 4).padLeft(Circuit.outputs, 12) << '\n';
+    out.padLeft("AIG", 5).padLeft(Circuit.ands, 11) << '\n';
+    out << "------------------\n";
+    out.padLeft("Total", 7)
+        .padLeft(Circuit.inputs + Circuit.outputs + Circuit.ands, 9)
+        << '\n';
 }
-void CirMgr::printNetlistformat(unsigned id, unsigned prid) const {
-    cout << "[" << prid << "] " << setiosflags(ios::left) << setw(4)
-         << Circuit.id2Gate[id]->getTypeStr() << resetiosflags(ios::left);
-    return;
+void CirMgr::printNetlistformat(MyOutBuf &out, unsigned id,
+                                unsigned prid) const {
+    out << '[' << prid << "] ";
+    out.padRight(CirGate(&Circuit, id).getTypeStr().c_str(), 4);
 }
-void CirMgr::DFSTravPO(unsigned id, unsigned &prid) const {
-    unsigned *c = Circuit.id2Gate[id]->getFanin();
-    // todo: print symbol
-    if (Circuit.id2Gate[id]->getType() == PO_GATE) {
-        if (!Circuit.id2Gate[*c / 2]->isGlobalref()) DFSTravPO(*c / 2, prid);
-        printNetlistformat(id, prid);
-        SymbolGate *s = dynamic_cast<SymbolGate *>(Circuit.id2Gate[id]);
-        cout << id << " "
-             << ((Circuit.id2Gate[*c / 2]->getType() == UNDEF_GATE) ? "*" : "")
-             << ((*c % 2 == 1) ? "!" : "") << *c / 2
-             << ((s->getSymbol() == 0)
-                     ? string("")
-                     : (string(" (") + string(s->getSymbol()) + string(")")))
-             << endl;
-
-    } else if (Circuit.id2Gate[id]->getType() == PI_GATE) {
-        printNetlistformat(id, prid);
-        SymbolGate *s = dynamic_cast<SymbolGate *>(Circuit.id2Gate[id]);
-        cout << id
-             << ((s->getSymbol() == 0)
-                     ? string("")
-                     : (string(" (") + string(s->getSymbol()) + string(")")))
-             << endl;
-    } else if (Circuit.id2Gate[id]->getType() == AIG_GATE) {
-        if (!Circuit.id2Gate[c[0] / 2]->isGlobalref()) {
-            DFSTravPO(c[0] / 2, prid);
-        }
-        if (!Circuit.id2Gate[c[1] / 2]->isGlobalref()) {
-            DFSTravPO(c[1] / 2, prid);
+// Iterative post-order DFS from the POs, so the depth of the netlist is
+// bounded by memory rather than by the call stack. A gate is marked when
+// it is pushed; in an acyclic netlist this yields the same order as the
+// recursive walk marking on return, and a cycle cannot loop forever.
+void CirMgr::buildDfsList() const {
+    TRACE_SPAN("buildDfsList");
+    MEM_PHASE("DFS");
+    _dfsList.clear();
+    _dfsList.reserve(Circuit.inputs + Circuit.ands + Circuit.outputs + 1);
+    CirTravCtx &trav = CirTravCtx::forThread();
+    trav.begin(Circuit.size());
+    // (gate id, index of the next fanin to visit)
+    vector<pair<unsigned, unsigned> > stack;
+    for (size_t i = Circuit.maxid + 1; i < Circuit.maxid + Circuit.outputs + 1;
+         i++) {
+        if (trav.isMarked(i)) continue;
+        trav.mark(i);
+        stack.push_back(make_pair(unsigned(i), 0u));
+        while (!stack.empty()) {
+            unsigned id = stack.back().first;
+            unsigned nFanin = (Circuit.type[id] == AIG_GATE)  ? 2
+                              : (Circuit.type[id] == PO_GATE) ? 1
+                                                               : 0;
+            if (stack.back().second < nFanin) {
+                unsigned c = Circuit.fanin[id * 2 + stack.back().second++] / 2;
+                if (!trav.isMarked(c)) {
+                    trav.mark(c);
+                    stack.push_back(make_pair(c, 0u));
+                }
+                continue;
+            }
+            stack.pop_back();
+            if (Circuit.type[id] != UNDEF_GATE) _dfsList.push_back(id);
         }
-        printNetlistformat(id, prid);
-        cout << id << " "
-             << ((Circuit.id2Gate[c[0] / 2]->getType() == UNDEF_GATE) ? "*"
-                                                                      : "")
-             << ((c[0] % 2 == 1) ? "!" : "") << c[0] / 2 << " "
-             << ((Circuit.id2Gate[c[1] / 2]->getType() == UNDEF_GATE) ? "*"
-                                                                      : "")
-             << ((c[1] % 2 == 1) ? "!" : "") << c[1] / 2 << endl;
-
-    } else if (Circuit.id2Gate[id]->getType() == UNDEF_GATE) {
-        Circuit.id2Gate[id]->setRefToGlobalRef();
-        return;
-    } else if (Circuit.id2Gate[id]->getType() == CONST_GATE) {
-        printNetlistformat(id, prid);
-        cout << id << endl;
-    } else {
-        // gate unknown type
-        printNetlistformat(id, prid);
-        cout << "0" << endl;
-    }
-    Circuit.id2Gate[id]->setRefToGlobalRef();
-    prid++;
-    return;
+    }
+    _dfsValid = true;
+}
+const vector<unsigned> &CirMgr::getDfsList() const {
+    lock_guard<mutex> lock(_dfsMutex);
+    if (!_dfsValid) buildDfsList();
+    return _dfsList;
 }
 
-void CirMgr::printNetlist() const {
-    CirGate::setGlobalref();
-    static unsigned printid = 0;
-    printid = 0;
-    // for( size_t i = 0;i<(Circuit.maxid + Circuit.outputs + 1);i++){
-    cout << endl;
-    for (size_t i = Circuit.maxid + 1; i < Circuit.maxid + Circuit.outputs + 1;
-         i++) {
-        DFSTravPO(i, printid);
-        //    cout << "id: "  << i << " " << Circuit.id2Gate[i]->getTypeStr() <<
-        //    endl;
+// " (name)" after a PI or PO with a symbol
+static void printSymbol(MyOutBuf &out, const char *sym) {
+    if (sym != 0) out << " (" << sym << ')';
+}
+// fanin literal c, "*" marking an undefined gate
+static void printFanin(MyOutBuf &out, const CirMgr::ParsedCir &cir,
+                       unsigned c) {
+    if (cir.type[c / 2] == UNDEF_GATE) out << '*';
+    if (c % 2 == 1) out << '!';
+    out << c / 2;
+}
+void CirMgr::printNetlist(ostream &os) const {
+    TRACE_SPAN("printNetlist");
+    const vector<unsigned> &dfs = getDfsList();
+    MyOutBuf out(os);
+    out << '\n';
+    for (size_t prid = 0; prid < dfs.size(); prid++) {
+        unsigned id = dfs[prid];
+        const unsigned *c = Circuit.fanin + id * 2;
+        printNetlistformat(out, id, prid);
+        if (Circuit.type[id] == PO_GATE) {
+            out << id << ' ';
+            printFanin(out, Circuit, c[0]);
+            printSymbol(out, Circuit.getSymbol(id));
+        } else if (Circuit.type[id] == PI_GATE) {
+            out << id;
+            printSymbol(out, Circuit.getSymbol(id));
+        } else if (Circuit.type[id] == AIG_GATE) {
+            out << id << ' ';
+            printFanin(out, Circuit, c[0]);
+            out << ' ';
+            printFanin(out, Circuit, c[1]);
+        } else if (Circuit.type[id] == CONST_GATE) {
+            out << id;
+        } else {
+            // gate unknown type
+            out << '0';
+        }
+        out << '\n';
     }
 }
 
 void CirMgr::printPIs() const {
-    cout << "PIs of the circuit:";
+    MyOutBuf out(cout);
+    out << "PIs of the circuit:";
     for (size_t i = 0; i < Circuit.inputs; i++) {
-        cout << " " << Circuit.PI_list[i];
+        out << ' ' << Circuit.PI_list[i];
     }
-    cout << endl;
+    out << '\n';
 }
 
 void CirMgr::printPOs() const {
-    cout << "POs of the circuit:";
+    MyOutBuf out(cout);
+    out << "POs of the circuit:";
     for (size_t i = Circuit.maxid + 1; i < Circuit.maxid + Circuit.outputs + 1;
          i++) {
-        if (Circuit.id2Gate[i] != 0 && Circuit.id2Gate[i]->getType() == PO_GATE)
-            cout << " " << i;
+        if (Circuit.type[i] == PO_GATE)
+            out << ' ' << i;
     }
-    cout << endl;
+    out << '\n';
 }
 
+// Each line is only printed if it lists a gate, so the ids are gathered
+// before the title goes out.
 void CirMgr::printFloatGates() const {
-    bool flag = false;
-    ss outs;
-    outs << "Gates with floating fanin(s):";
-    for (size_t i = 0; i < Circuit.maxid + Circuit.outputs + 1; i++) {
-        if (Circuit.id2Gate[i] != 0) {
-            unsigned *c = Circuit.id2Gate[i]->getFanin();
-            if (Circuit.id2Gate[i]->getType() == PO_GATE &&
-                Circuit.id2Gate[*c / 2]->getType() == UNDEF_GATE) {
-                outs << " " << i;
-                flag = true;
-            } else if (Circuit.id2Gate[i]->getType() == AIG_GATE) {
-                if (Circuit.id2Gate[c[0] / 2]->getType() == UNDEF_GATE ||
-                    Circuit.id2Gate[c[1] / 2]->getType() == UNDEF_GATE) {
-                    outs << " " << i;
-                    flag = true;
+    TRACE_SPAN("printFloatGates");
+    IdList ids;
+    for (size_t i = 0; i < Circuit.size(); i++) {
+        if (Circuit.exists(i)) {
+            const unsigned *c = Circuit.fanin + i * 2;
+            if (Circuit.type[i] == PO_GATE &&
+                Circuit.type[*c / 2] == UNDEF_GATE) {
+                ids.push_back(i);
+            } else if (Circuit.type[i] == AIG_GATE) {
+                if (Circuit.type[c[0] / 2] == UNDEF_GATE ||
+                    Circuit.type[c[1] / 2] == UNDEF_GATE) {
+                    ids.push_back(i);
                 }
             }
         }
     }
-    if (flag) cout << outs.str() << endl;
-    outs.str("");
-    flag = false;
-    outs << "Gates defined but not used  :";
+    MyOutBuf out(cout);
+    if (!ids.empty()) {
+        out << "Gates with floating fanin(s):";
+        for (size_t i = 0; i < ids.size(); i++) out << ' ' << ids[i];
+        out << '\n';
+    }
+    ids.clear();
     for (size_t i = 1; i < Circuit.maxid + 1; i++) {
-        if (Circuit.id2Gate[i] != 0) {
-            if (Circuit.id2Gate[i]->getFanout().empty()) {
-                outs << " " << i;
-                flag = true;
+        if (Circuit.exists(i)) {
+            if (Circuit.getFanoutNum(i) == 0) {
+                ids.push_back(i);
             }
         }
     }
-    if (flag) cout << outs.str() << endl;
-    return;
+    if (!ids.empty()) {
+        out << "Gates defined but not used  :";
+        for (size_t i = 0; i < ids.size(); i++) out << ' ' << ids[i];
+        out << '\n';
+    }
 }
-void CirMgr::writeAag(ostream &outfile) const {
-    outfile << "aag " << Circuit.maxid << " " << Circuit.inputs << " "
-            << Circuit.latches << " " << Circuit.outputs << " ";      
-    //outfile << trueaig << endl;
-    CirGate::setGlobalref();
-    vector<unsigned> AIGlist;
-    for (size_t i = Circuit.maxid + 1; i < Circuit.maxid + Circuit.outputs + 1;
-         i++) {
-        Circuit.writeAig(i,AIGlist);
+// One line per FEC group, groups ordered by their smallest gate id and
+// members by id; "!" marks a member whose signature is the complement of
+// the group's first one.
+void CirMgr::printFECPairs() const {
+    TRACE_SPAN("printFECPairs");
+    vector<IdList> groups(_fecGroups);
+    for (size_t g = 0; g < groups.size(); g++)
+        sort(groups[g].begin(), groups[g].end());
+    sort(groups.begin(), groups.end());
+    MyOutBuf out(cout);
+    for (size_t g = 0; g < groups.size(); g++) {
+        out << '[' << g << ']';
+        for (size_t i = 0; i < groups[g].size(); i++)
+            out << ' ' << (((groups[g][i] ^ groups[g][0]) & 1) ? "!" : "")
+                << groups[g][i] / 2;
+        out << '\n';
     }
-    outfile << AIGlist.size() / 3 << endl;
+}
+// Bytes of every gate array and cache, as allocated; the arena row is
+// what MyArena took from malloc beyond the arrays it holds.
+void CirMgr::printMemory() const {
+    const size_t n = Circuit.size();
+    const size_t syms = Circuit.inputs + Circuit.outputs;
+    size_t strBytes = 0;
+    for (size_t i = 0; i < syms && Circuit.symbol != 0; i++)
+        if (Circuit.symbol[i] != 0) strBytes += strlen(Circuit.symbol[i]) + 1;
+    size_t fecBytes = _fecGroups.capacity() * sizeof(IdList);
+    for (size_t g = 0; g < _fecGroups.size(); g++)
+        fecBytes += _fecGroups[g].capacity() * sizeof(unsigned);
+    // inArena: the row is carved from Circuit.arena, whose slack is the
+    // rest of what the arena holds
+    struct MemRow {
+        const char *name;
+        size_t bytes;
+        bool inArena;
+    };
+    const MemRow rows[] = {
+        {"type", n * sizeof(unsigned char), true},
+        {"fanin", n * 2 * sizeof(unsigned), true},
+        {"lineNo", n * sizeof(unsigned), true},
+        {"PI_list", Circuit.inputs * sizeof(unsigned), true},
+        {"symbol", syms * sizeof(char *), true},
+        {"symbol strings", strBytes, true},
+        {"fanoutOfs", Circuit.fanoutOfs ? (n + 1) * sizeof(unsigned) : 0,
+         false},
+        {"fanoutLit",
+         Circuit.fanoutOfs ? Circuit.fanoutOfs[n] * sizeof(unsigned) : 0,
+         false},
+        {"dfsList", _dfsList.capacity() * sizeof(unsigned), false},
+        {"simValue", _simValue.capacity() * sizeof(uint64_t), false},
+        {"simLevel", _simLevel.capacity() * sizeof(unsigned), false},
+        {"fecGroups", fecBytes, false}};
+    const size_t nRows = sizeof(rows) / sizeof(rows[0]);
+    size_t inArena = 0, total = 0;
+    for (size_t r = 0; r < nRows; r++) {
+        if (rows[r].inArena) inArena += rows[r].bytes;
+        total += rows[r].bytes;
+    }
+    const size_t arena = Circuit.arena.getAllocated();
+    const size_t slack = arena > inArena ? arena - inArena : 0;
+    total += slack;
+
+    MyOutBuf out(cout);
+    out << "\nMemory by Structure\n"
+        << "=========================\n";
+    for (size_t r = 0; r < nRows; r++)
+        out.padRight(rows[r].name, 15).padLeft(rows[r].bytes, 10) << '\n';
+    out.padRight("arena slack", 15).padLeft(slack, 10) << '\n';
+    out << "-------------------------\n";
+    out.padRight("Total", 15).padLeft(total, 10) << '\n';
+    out.padRight("Bytes/gate", 15).padLeft(n > 1 ? total / (n - 1) : 0, 10)
+        << '\n';
+}
+// The ANDs are written in DFS order straight from the netlist; only
+// their count is needed before the first line.
+void CirMgr::writeAag(ostream &outfile) const {
+    TRACE_SPAN("writeAag");
+    MEM_PHASE("write");
+    const vector<unsigned> &dfs = getDfsList();
+    size_t ands = 0;
+    for (size_t i = 0; i < dfs.size(); i++)
+        if (Circuit.type[dfs[i]] == AIG_GATE) ands++;
+    MyOutBuf out(outfile);
+    out << "aag " << Circuit.maxid << ' ' << Circuit.inputs << ' '
+        << Circuit.latches << ' ' << Circuit.outputs << ' ' << ands << '\n';
     for (size_t i = 0; i < Circuit.inputs; i++) {
-        outfile << Circuit.PI_list[i] * 2 << endl;
+        out << Circuit.PI_list[i] * 2 << '\n';
     }
     for (size_t i = Circuit.maxid + 1; i < Circuit.outputs + Circuit.maxid + 1;
          i++) {
-        outfile << *(Circuit.id2Gate[i]->getFanin()) << endl;
+        out << Circuit.fanin[i * 2] << '\n';
     }
-    for (size_t i = 0; i < AIGlist.size();
-         i+=3) {
-        outfile << AIGlist[i] << " " << AIGlist[i+1] << " " << AIGlist[i+2] << endl; 
+    for (size_t i = 0; i < dfs.size(); i++) {
+        if (Circuit.type[dfs[i]] != AIG_GATE) continue;
+        const unsigned *c = Circuit.fanin + dfs[i] * 2;
+        out << dfs[i] * 2 << ' ' << c[0] << ' ' << c[1] << '\n';
     }
     for (size_t i = 0; i < Circuit.inputs; i++) {
-        SymbolGate *s =
-            dynamic_cast<SymbolGate *>(Circuit.id2Gate[Circuit.PI_list[i]]);
-        if (s->getSymbol() != 0) {
-            outfile << "i" << i << " " << s->getSymbol() << endl;
+        const char *sym = Circuit.symbol[i];
+        if (sym != 0) {
+            out << 'i' << i << ' ' << sym << '\n';
         }
     }
     for (size_t i = Circuit.maxid + 1; i < Circuit.maxid + Circuit.outputs + 1;
          i++) {
-        SymbolGate *s = dynamic_cast<SymbolGate *>(Circuit.id2Gate[i]);
-        if (s->getSymbol() != 0) {
-            outfile << "o" << i - (Circuit.maxid + 1) << " " << s->getSymbol()
-                    << endl;
+        const char *sym = Circuit.getSymbol(i);
+        if (sym != 0) {
+            out << 'o' << i - (Circuit.maxid + 1) << ' ' << sym << '\n';
         }
     }
-    outfile << "c" << endl << "AAG output by b06901048 Justin Chen" << endl;
+    out << "c\nAAG output by b06901048 Justin Chen\n";
 }
-void CirMgr::ParsedCir::writeAig(int id,vector<unsigned>& AIGlist) const {
-    unsigned *c = id2Gate[id]->getFanin();
-    if (id2Gate[id]->getType() == PO_GATE) {
-        if (!id2Gate[*c / 2]->isGlobalref()) writeAig(*c / 2, AIGlist);
-    } else if (id2Gate[id]->getType() == AIG_GATE) {
-        if (!id2Gate[c[0] / 2]->isGlobalref()) {
-            writeAig(c[0] / 2,AIGlist);
-        }
-        if (!id2Gate[c[1] / 2]->isGlobalref()) {
-            writeAig(c[1] / 2,AIGlist);
-        }
-        AIGlist.push_back(id*2);
-        AIGlist.push_back(c[0]);
-        AIGlist.push_back(c[1]);
-        //outfile << id * 2 << " " << c[0] << " " << c[1] << endl;
+// AIGER varint: 7 bits per byte, high bit set on all but the last byte
+static void putDelta(MyOutBuf &out, unsigned x) {
+    while (x & ~0x7fu) {
+        out << char((x & 0x7f) | 0x80);
+        x >>= 7;
+    }
+    out << char(x);
+}
+// Binary AIGER requires inputs to be variables 1..I and ANDs to follow in
+// topological order, so everything is renumbered along the DFS order.
+// Undefined fanins have no variable of their own and are tied to const 0.
+void CirMgr::writeBinaryAig(ostream &outfile) const {
+    TRACE_SPAN("writeBinaryAig");
+    MEM_PHASE("write");
+    const vector<unsigned> &dfs = getDfsList();
+    vector<unsigned> var(Circuit.maxid + 1, 0);
+    for (size_t i = 0; i < Circuit.inputs; i++)
+        var[Circuit.PI_list[i]] = i + 1;
+    size_t ands = 0;
+    for (size_t i = 0; i < dfs.size(); i++)
+        if (Circuit.type[dfs[i]] == AIG_GATE)
+            var[dfs[i]] = Circuit.inputs + ++ands;
+
+    MyOutBuf out(outfile);
+    out << "aig " << Circuit.inputs + ands << ' ' << Circuit.inputs << " 0 "
+        << Circuit.outputs << ' ' << ands << '\n';
+    for (size_t i = Circuit.maxid + 1; i < Circuit.outputs + Circuit.maxid + 1;
+         i++) {
+        unsigned f = Circuit.fanin[i * 2];
+        out << var[f / 2] * 2 + f % 2 << '\n';
+    }
+    for (size_t i = 0; i < dfs.size(); i++) {
+        if (Circuit.type[dfs[i]] != AIG_GATE) continue;
+        unsigned lhs = var[dfs[i]] * 2;
+        const unsigned *c = Circuit.fanin + dfs[i] * 2;
+        unsigned r0 = var[c[0] / 2] * 2 + c[0] % 2;
+        unsigned r1 = var[c[1] / 2] * 2 + c[1] % 2;
+        if (r0 < r1) swap(r0, r1);
+        putDelta(out, lhs - r0);
+        putDelta(out, r0 - r1);
+    }
+    for (size_t i = 0; i < Circuit.inputs; i++) {
+        const char *sym = Circuit.symbol[i];
+        if (sym != 0) out << 'i' << i << ' ' << sym << '\n';
+    }
+    for (size_t i = 0; i < Circuit.outputs; i++) {
+        const char *sym = Circuit.symbol[Circuit.inputs + i];
+        if (sym != 0) out << 'o' << i << ' ' << sym << '\n';
     }
-    id2Gate[id]->setRefToGlobalRef();
-    return;
+    out << "c\nAIG output by b06901048 Justin Chen\n";
 }
@@ -9,8 +9,11 @@
 #ifndef CIR_MGR_H
 #define CIR_MGR_H
 
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -18,64 +21,181 @@
 using namespace std;
 
 #include "cirDef.h"
+#include "myArena.h"
 
 extern CirMgr *cirMgr;
 
+class CirReadBuf;
+class MyOutBuf;
+class MyThreadPool;
+
 // TODO: Define your own data members and member functions
 class CirMgr {
    public:
-    CirMgr() {}
+    CirMgr() : _dfsValid(false), _fecValid(false), _simPatterns(0) {}
     ~CirMgr() {}
 
     // Access functions
-    // return '0' if "gid" corresponds to an undefined gate.
-    CirGate *getGate(unsigned gid) const { 
-        return (gid <= Circuit.maxid+Circuit.outputs)? Circuit.id2Gate[gid] : 0 ;
+    CirGate getGate(unsigned gid) const;
+    // Gate ids reachable from the POs in DFS post-order (fanins before
+    // fanouts, POs in PO order); UNDEF gates are left out. Computed on
+    // first use, by one thread if several ask at once, and cached until
+    // invalidateDfsList().
+    const vector<unsigned> &getDfsList() const;
+    // any pass that changes the netlist must call this; it also drops the
+    // FEC groups and the last simulated block, whose values and levels
+    // belong to the old netlist
+    void invalidateDfsList() {
+        _dfsValid = false;
+        _fecValid = false;
+        _fecGroups.clear();
+        _simValue.clear();
+        _simLevel.clear();
     }
 
     // Member functions about circuit construction
-    bool readCircuit(const string &);
+    // nThreads > 1 parses the AND section and builds fanouts in parallel;
+    // building fanouts then takes up to 4 more bytes per fanin edge
+    bool readCircuit(const string &, unsigned nThreads = 1);
+    // Shape of a synthetic circuit for genAag(); see cirGen.cpp. Needs
+    // at least one PI; percentages are 0..100.
+    struct GenParam {
+        size_t inputs, outputs, ands, depth;
+        unsigned hubPct, undefPct, floatPct, seed;
+    };
+    // write a random circuit of shape p as AAG; the same p gives the same
+    // file
+    static void genAag(ostream &, const GenParam &);
 
     // Member functions about circuit reporting
     void printSummary() const;
-    void printNetlist() const;
+    void printNetlist(ostream & = cout) const;
     void printPIs() const;
     void printPOs() const;
     void printFloatGates() const;
+    void printFECPairs() const;
+    // bytes held by each gate array and cache
+    void printMemory() const;
     void writeAag(ostream &) const;
+    void writeBinaryAig(ostream &) const;
+
+    // Member functions about circuit optimization
+    void sweep();
+    void optimize();
+    void strash();
+    // nThreads = 0 proves on this thread with one solver; nThreads >= 1
+    // uses a fixed set of solvers on that many threads, with the same
+    // result for every nThreads (see fraigParallel())
+    void fraig(unsigned nThreads = 0);
+
+    // Member functions about simulation
+    // patterns per gate and pass: SIM_WORDS 64-bit words
+    static const unsigned SIM_WORDS = 8;
+    // nThreads > 1 simulates by logic level, or with splitWords, gives
+    // each thread blocks of patterns of its own
+    void randomSim(unsigned nThreads = 1, bool splitWords = false);
+    // patterns/s of every simulation kernel the CPU supports, and of the
+    // threaded modes for nThreads > 1
+    void benchSim(unsigned nThreads = 1);
+    // flip the given PI ids in the last simulated block and re-simulate
+    // their changed fanout cones only
+    void flipSim(const IdList &);
+    // Gates are kept as a structure of arrays indexed by gate id; POs take
+    // the ids after maxid. An AND costs 13 bytes here plus 4 bytes per
+    // fanout and one 4-byte fanout offset.
     class ParsedCir {
        public:
         ParsedCir()
-            : maxid(0),
-              inputs(0),
+            : inputs(0),
               outputs(0),
               ands(0),
-              id2Gate(0),
+              maxid(0),
               latches(0),
-              PI_list(0) {}
+              PI_list(0),
+              type(0),
+              fanin(0),
+              lineNo(0),
+              fanoutOfs(0),
+              fanoutLit(0),
+              symbol(0) {}
+        // the gate arrays and symbols go away with arena
         ~ParsedCir() {
-            for (size_t i = 0; i < maxid + outputs; i++) {
-                if (id2Gate[i] != 0) delete id2Gate[i];
-            }
-            delete[] id2Gate;
-            delete[] PI_list;
+            delete[] fanoutOfs;
+            delete[] fanoutLit;
+        }
+        // allocate the gate arrays for the header counts; no gate defined
+        void allocGates();
+        size_t size() const { return maxid + outputs + 1; }
+        bool exists(unsigned id) const { return type[id] != TOT_GATE; }
+        GateType getType(unsigned id) const { return GateType(type[id]); }
+        unsigned getFanoutNum(unsigned id) const {
+            return fanoutOfs[id + 1] - fanoutOfs[id];
+        }
+        const char *getSymbol(unsigned id) const {
+            if (type[id] == PI_GATE) return symbol[fanin[2 * id]];
+            if (type[id] == PO_GATE) return symbol[inputs + id - maxid - 1];
+            return 0;
+        }
+        // k is the PI position, or inputs + the PO position
+        void setSymbol(size_t k, const char *s, size_t n) {
+            symbol[k] = arena.strdup(s, n);
         }
-        void writeAig(int id,vector<unsigned>& AIGlist) const;
         size_t inputs, outputs, ands, maxid, latches;
         //stored with id
         unsigned *PI_list;
-        //index is id
-        CirGate **id2Gate;
+        // gate store, index is id
+        // GateType per id; TOT_GATE marks an id with no gate
+        unsigned char *type;
+        // two fanin literals per id (PO uses the first one);
+        // a PI keeps its PI position in the first slot
+        unsigned *fanin;
+        unsigned *lineNo;
+        // CSR fanout index: literals of id's fanouts are
+        // fanoutLit[fanoutOfs[id] .. fanoutOfs[id + 1])
+        unsigned *fanoutOfs;
+        unsigned *fanoutLit;
+        // PI symbols followed by PO symbols, 0 if unnamed
+        char **symbol;
+        // owns every array above except the fanout index, which
+        // ConstructCir may rebuild, and all symbol strings
+        MyArena arena;
     };
     ParsedCir Circuit;
 
    private:
-    void DFSTravPO(unsigned, unsigned &) const;
-    void printNetlistformat(unsigned, unsigned) const;
-    bool ParseHeader(ifstream &);
+    mutable vector<unsigned> _dfsList;
+    mutable bool _dfsValid;
+    mutable mutex _dfsMutex;
+    // SIM_WORDS words per gate id, from the latest simulated block
+    vector<uint64_t> _simValue;
+    // logic level per gate id for _simValue, see levelize()
+    IdList _simLevel;
+    // FEC groups of gate literals; the literal's phase is the gate's first
+    // simulated bit. Valid once simulated, until the netlist changes.
+    vector<IdList> _fecGroups;
+    bool _fecValid;
+    size_t _simPatterns;
+
+    void buildDfsList() const;
+    void printNetlistformat(MyOutBuf &, unsigned, unsigned) const;
+    bool ParseHeader(CirReadBuf &);
     void HeaderError(string& errstr);
-    bool GenGates(ifstream &);
-    bool ConstructCir();
+    bool GenGates(CirReadBuf &, unsigned);
+    bool GenAndGates(CirReadBuf &, unsigned);
+    bool defineAnd(const unsigned *, size_t);
+    void countFanout(unsigned);
+    bool ConstructCir(unsigned);
+    bool ConstructCirParallel(unsigned);
+    void levelize(IdList &) const;
+    void buildSimProg(IdList &, IdList * = 0) const;
+    void simulateBlock(uint64_t *, const IdList &, const IdList &,
+                       MyThreadPool &);
+    void mergeGate(unsigned, unsigned);
+    void fraigParallel(unsigned);
+    void refineByCex(vector<IdList> &, const vector<bool> &, const IdList &,
+                     const vector<uint64_t> &);
+    void initFecGroups(const uint64_t *);
+    void refineFecGroups(vector<IdList> &, const uint64_t *) const;
 };
 
 #endif  // CIR_MGR_H
@@ -0,0 +1,85 @@
+/****************************************************************************
+  FileName     [ cirOpt.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir optimization functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "cirGate.h"
+#include "cirMgr.h"
+#include "util.h"
+
+using namespace std;
+
+/**************************************************/
+/*   Public member functions about optimization   */
+/**************************************************/
+// Remove the AIG and UNDEF gates that cannot be reached from any PO.
+// A gate is reachable if it is in the DFS list or is a fanin of a gate
+// in it; the latter catches the UNDEF gates, which the list leaves out.
+// PIs and the constant are always kept.
+void CirMgr::sweep() {
+    TRACE_SPAN("sweep");
+    MEM_PHASE("optimize");
+    const vector<unsigned> &dfs = getDfsList();
+    vector<bool> used(Circuit.size(), false);
+    for (size_t i = 0; i < dfs.size(); i++) {
+        unsigned id = dfs[i];
+        const unsigned *c = Circuit.fanin + id * 2;
+        used[id] = true;
+        if (Circuit.type[id] == AIG_GATE) {
+            used[c[0] / 2] = true;
+            used[c[1] / 2] = true;
+        } else if (Circuit.type[id] == PO_GATE)
+            used[c[0] / 2] = true;
+    }
+    size_t removed = 0;
+    for (size_t id = 1; id <= Circuit.maxid; id++) {
+        if (used[id]) continue;
+        if (Circuit.type[id] == AIG_GATE) {
+            cout << "Sweeping: AIG(" << id << ") removed..." << endl;
+            Circuit.ands--;
+        } else if (Circuit.type[id] == UNDEF_GATE)
+            cout << "Sweeping: UNDEF(" << id << ") removed..." << endl;
+        else
+            continue;
+        Circuit.type[id] = TOT_GATE;
+        removed++;
+    }
+    if (removed != 0) ConstructCir(1);
+}
+
+// Fold every AND in DFS order whose fanins make it trivial:
+//   a & 0 = 0,   a & 1 = a,   a & a = a,   a & !a = 0
+// Fanins are rewritten in place when a gate is merged, so a gate sees
+// its folded fanins by the time it is visited. Gates left floating are
+// kept for CIRSWeep. The fanout index is rebuilt once at the end.
+void CirMgr::optimize() {
+    TRACE_SPAN("optimize");
+    MEM_PHASE("optimize");
+    const vector<unsigned> &dfs = getDfsList();
+    size_t merged = 0;
+    for (size_t i = 0; i < dfs.size(); i++) {
+        unsigned id = dfs[i];
+        if (Circuit.type[id] != AIG_GATE) continue;
+        const unsigned *c = Circuit.fanin + id * 2;
+        unsigned lit;
+        if (c[0] == 0 || c[1] == 0 || c[0] == (c[1] ^ 1))
+            lit = 0;
+        else if (c[0] == 1)
+            lit = c[1];
+        else if (c[1] == 1 || c[0] == c[1])
+            lit = c[0];
+        else
+            continue;
+        cout << "Simplifying: " << lit / 2 << " merging "
+             << ((lit & 1) ? "!" : "") << id << "..." << endl;
+        mergeGate(lit, id);
+        merged++;
+    }
+    if (merged != 0) ConstructCir(1);
+}
@@ -0,0 +1,511 @@
+/****************************************************************************
+  FileName     [ cirSim.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir simulation functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CIR_SIM_X86
+#endif
+#include "cirGate.h"
+#include "cirMgr.h"
+#include "myThreadPool.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+// FEC groups are compared every SIM_CHECK_BLOCKS blocks, and simulation
+// stops after SIM_MAX_FAILS comparisons in a row without a split
+enum {
+    SIM_CHECK_BLOCKS = 8,
+    SIM_MAX_FAILS = 4,
+    SIM_BENCH_BLOCKS = 256
+};
+static_assert(CirMgr::SIM_WORDS == 8,
+              "simulation kernels assume 512 patterns per gate");
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// rnGen only yields 31 random bits per call and costs a library call
+// each, far more than evaluating an AND word. It only seeds a splitmix64
+// stream that produces the PI words.
+static uint64_t randomSeed() {
+    uint64_t w = 0;
+    for (int i = 0; i < 4; i++) w = (w << 16) | (rnGen(1 << 16) & 0xffff);
+    return w;
+}
+static inline uint64_t nextRandom(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+// The AND kernels evaluate prog, a topologically ordered list of
+// (output id, fanin literal, fanin literal) triples, over SIM_WORDS words
+// per gate: (a ^ ia) & (b ^ ib) where ia/ib are all ones for an inverted
+// fanin. Every kernel gives the same result; the widest one the CPU
+// supports is picked at run time.
+typedef void (*SimKernel)(uint64_t *, const unsigned *, size_t);
+
+static void simAndScalar(uint64_t *sim, const unsigned *prog, size_t n) {
+    for (size_t i = 0; i < n; i++, prog += 3) {
+        const uint64_t *a = sim + (prog[1] / 2) * CirMgr::SIM_WORDS;
+        const uint64_t *b = sim + (prog[2] / 2) * CirMgr::SIM_WORDS;
+        const uint64_t ma = (prog[1] & 1) ? ~uint64_t(0) : 0;
+        const uint64_t mb = (prog[2] & 1) ? ~uint64_t(0) : 0;
+        uint64_t *o = sim + prog[0] * CirMgr::SIM_WORDS;
+        for (unsigned k = 0; k < CirMgr::SIM_WORDS; k++)
+            o[k] = (a[k] ^ ma) & (b[k] ^ mb);
+    }
+}
+#ifdef CIR_SIM_X86
+__attribute__((target("avx2"))) static void simAndAvx2(uint64_t *sim,
+                                                        const unsigned *prog,
+                                                        size_t n) {
+    for (size_t i = 0; i < n; i++, prog += 3) {
+        const __m256i *a =
+            (const __m256i *)(sim + (prog[1] / 2) * CirMgr::SIM_WORDS);
+        const __m256i *b =
+            (const __m256i *)(sim + (prog[2] / 2) * CirMgr::SIM_WORDS);
+        const __m256i ma = _mm256_set1_epi64x(-(long long)(prog[1] & 1));
+        const __m256i mb = _mm256_set1_epi64x(-(long long)(prog[2] & 1));
+        __m256i *o = (__m256i *)(sim + prog[0] * CirMgr::SIM_WORDS);
+        for (unsigned k = 0; k < 2; k++)
+            _mm256_storeu_si256(
+                o + k, _mm256_and_si256(
+                           _mm256_xor_si256(_mm256_loadu_si256(a + k), ma),
+                           _mm256_xor_si256(_mm256_loadu_si256(b + k), mb)));
+    }
+}
+__attribute__((target("avx512f"))) static void simAndAvx512(
+    uint64_t *sim, const unsigned *prog, size_t n) {
+    for (size_t i = 0; i < n; i++, prog += 3) {
+        const uint64_t *a = sim + (prog[1] / 2) * CirMgr::SIM_WORDS;
+        const uint64_t *b = sim + (prog[2] / 2) * CirMgr::SIM_WORDS;
+        const __m512i ma = _mm512_set1_epi64(-(long long)(prog[1] & 1));
+        const __m512i mb = _mm512_set1_epi64(-(long long)(prog[2] & 1));
+        _mm512_storeu_si512(
+            sim + prog[0] * CirMgr::SIM_WORDS,
+            _mm512_and_si512(_mm512_xor_si512(_mm512_loadu_si512(a), ma),
+                             _mm512_xor_si512(_mm512_loadu_si512(b), mb)));
+    }
+}
+#endif
+
+struct SimKernelInfo {
+    const char *name;
+    SimKernel run;
+    bool supported;
+};
+// all kernels, widest first; the scalar one is always supported
+static vector<SimKernelInfo> makeSimKernels() {
+    vector<SimKernelInfo> kernels;
+#ifdef CIR_SIM_X86
+    __builtin_cpu_init();
+    kernels.push_back(SimKernelInfo{
+        "avx512", simAndAvx512, bool(__builtin_cpu_supports("avx512f"))});
+    kernels.push_back(SimKernelInfo{"avx2", simAndAvx2,
+                                    bool(__builtin_cpu_supports("avx2"))});
+#endif
+    kernels.push_back(SimKernelInfo{"scalar", simAndScalar, true});
+    return kernels;
+}
+// Initialized once, on first use from whichever thread; C++11 makes that
+// initialization thread-safe.
+static const vector<SimKernelInfo> &simKernels() {
+    static const vector<SimKernelInfo> kernels = makeSimKernels();
+    return kernels;
+}
+static SimKernel findBestSimKernel() {
+    const vector<SimKernelInfo> &kernels = simKernels();
+    for (size_t i = 0; i < kernels.size(); i++)
+        if (kernels[i].supported) return kernels[i].run;
+    return simAndScalar;
+}
+static SimKernel bestSimKernel() {
+    static const SimKernel best = findBestSimKernel();
+    return best;
+}
+
+// PI words of one block, drawn from the splitmix64 stream
+static void setRandomPIs(const CirMgr::ParsedCir &cir, uint64_t *sim,
+                         uint64_t &rnState) {
+    for (size_t i = 0; i < cir.inputs; i++) {
+        uint64_t *v = sim + cir.PI_list[i] * CirMgr::SIM_WORDS;
+        for (unsigned k = 0; k < CirMgr::SIM_WORDS; k++)
+            v[k] = nextRandom(rnState);
+    }
+}
+/************************************************/
+/*   Public member functions about Simulation   */
+/************************************************/
+// Random simulation over the cached DFS order. Every gate id owns
+// SIM_WORDS 64-bit words, so one pass over the ANDs evaluates
+// 64 * SIM_WORDS patterns. After each block the FEC groups are refined;
+// new patterns are added until the groups stop splitting for
+// SIM_MAX_FAILS checks in a row, or no group is left.
+//
+// With nThreads > 1 the ANDs are grouped by logic level and every level
+// is split among the threads, or, with splitWords, each thread simulates
+// a whole block of its own and the blocks are refined in order. Both give
+// exactly the patterns and groups of the single-threaded run.
+void CirMgr::randomSim(unsigned nThreads, bool splitWords) {
+    TRACE_SPAN("randomSim");
+    MEM_PHASE("sim");
+    const size_t n = Circuit.size();
+    _simPatterns = 0;
+
+    IdList prog, levelEnd;
+    buildSimProg(prog, (nThreads > 1 && !splitWords) ? &levelEnd : 0);
+
+    MyThreadPool pool(nThreads);
+    const unsigned nBufs = splitWords ? pool.size() : 1;
+    vector<vector<uint64_t> > buf(nBufs, vector<uint64_t>(n * SIM_WORDS, 0));
+    uint64_t rnState = randomSeed();
+    size_t block = 0, fails = 0;
+    size_t groups = _fecGroups.size(), members = 0;
+    unsigned last = 0;
+    bool done = false;
+    const SimKernel kernel = bestSimKernel();
+    while (!done) {
+        for (unsigned j = 0; j < nBufs; j++)
+            setRandomPIs(Circuit, &buf[j][0], rnState);
+        if (splitWords)
+            pool.run([&](unsigned t) {
+                TRACE_SPAN("simulateWords");
+                if (!prog.empty())
+                    kernel(&buf[t][0], &prog[0], prog.size() / 3);
+            });
+        else
+            simulateBlock(&buf[0][0], prog, levelEnd, pool);
+        for (unsigned j = 0; j < nBufs && !done; j++) {
+            if (!_fecValid) initFecGroups(&buf[j][0]);
+            refineFecGroups(_fecGroups, &buf[j][0]);
+            _simPatterns += 64 * SIM_WORDS;
+            last = j;
+            if (_fecGroups.empty()) done = true;
+            if (++block % SIM_CHECK_BLOCKS != 0) continue;
+            size_t m = 0;
+            for (size_t i = 0; i < _fecGroups.size(); i++)
+                m += _fecGroups[i].size();
+            if (_fecGroups.size() != groups || m != members) {
+                groups = _fecGroups.size();
+                members = m;
+                fails = 0;
+            } else if (++fails == SIM_MAX_FAILS)
+                done = true;
+        }
+    }
+    _simValue.swap(buf[last]);
+    levelize(_simLevel);
+    cout << "Total #FEC Group = " << _fecGroups.size() << endl
+         << _simPatterns << " patterns simulated." << endl;
+}
+
+// Time every simulation kernel on the same random PI words, verify they
+// agree with the scalar one, and report patterns per second. With
+// nThreads > 1 the levelized and the word-split modes are timed, too.
+void CirMgr::benchSim(unsigned nThreads) {
+    IdList prog, levelProg, levelEnd;
+    buildSimProg(prog);
+    buildSimProg(levelProg, &levelEnd);
+    const size_t ands = prog.size() / 3;
+    _simValue.assign(Circuit.size() * SIM_WORDS, 0);
+    uint64_t rnState = randomSeed();
+    for (size_t i = 0; i < Circuit.inputs; i++) {
+        uint64_t *v = &_simValue[Circuit.PI_list[i] * SIM_WORDS];
+        for (unsigned k = 0; k < SIM_WORDS; k++) v[k] = nextRandom(rnState);
+    }
+    const size_t patterns = size_t(SIM_BENCH_BLOCKS) * 64 * SIM_WORDS;
+    cout << "Simulating " << ands << " ANDs with " << patterns
+         << " patterns per kernel" << endl;
+
+    const vector<SimKernelInfo> &kernels = simKernels();
+    vector<uint64_t> golden;
+    for (size_t i = kernels.size(); i-- > 0;) {
+        cout << "  " << setw(8) << left << kernels[i].name << right;
+        if (!kernels[i].supported) {
+            cout << "not supported" << endl;
+            continue;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (size_t b = 0; b < SIM_BENCH_BLOCKS && ands != 0; b++)
+            kernels[i].run(&_simValue[0], &prog[0], ands);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() -
+                                              start).count();
+        cout << setw(14) << fixed << setprecision(0)
+             << (sec > 0 ? patterns / sec : 0) << " patterns/s" << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+        if (golden.empty())
+            golden = _simValue;
+        else if (golden != _simValue)
+            cerr << "Error: kernel " << kernels[i].name
+                 << " disagrees with scalar simulation!!" << endl;
+    }
+    for (size_t i = 0; i < kernels.size(); i++)
+        if (kernels[i].supported) {
+            cout << "Using " << kernels[i].name << " kernel" << endl;
+            break;
+        }
+    if (nThreads > 1) {
+        MyThreadPool pool(nThreads);
+        const vector<uint64_t> init = _simValue;
+        vector<vector<uint64_t> > buf(pool.size(), init);
+        for (int mode = 0; mode < 2; mode++) {
+            cout << "  " << (mode == 0 ? "level" : "word") << " x" << left
+                 << setw(mode == 0 ? 1 : 2) << pool.size() << right;
+            chrono::steady_clock::time_point start =
+                chrono::steady_clock::now();
+            if (mode == 0) {
+                for (size_t b = 0; b < SIM_BENCH_BLOCKS; b++)
+                    simulateBlock(&_simValue[0], levelProg, levelEnd, pool);
+            } else {
+                const SimKernel kernel = bestSimKernel();
+                pool.run([&](unsigned t) {
+                    for (size_t b = t; b < SIM_BENCH_BLOCKS && ands != 0;
+                         b += pool.size())
+                        kernel(&buf[t][0], &prog[0], ands);
+                });
+            }
+            double sec = chrono::duration<double>(
+                             chrono::steady_clock::now() - start).count();
+            cout << setw(14) << fixed << setprecision(0)
+                 << (sec > 0 ? patterns / sec : 0) << " patterns/s" << endl;
+            cout.unsetf(ios::floatfield);
+            cout << setprecision(6);
+            if (golden != (mode == 0 ? _simValue : buf[0]))
+                cerr << "Error: " << (mode == 0 ? "levelized" : "word-split")
+                     << " simulation disagrees with scalar simulation!!"
+                     << endl;
+        }
+    }
+    levelize(_simLevel);
+    _simPatterns = 0;
+}
+
+// Flip every pattern bit of the given PIs in the last simulated block and
+// update the values event-driven: only fanouts of gates whose words
+// actually changed are scheduled, and a min-queue on logic level
+// evaluates each of them once, after all of its changed fanins. The block
+// must be simulated on the current netlist; any change to it drops the
+// block (see invalidateDfsList()).
+void CirMgr::flipSim(const IdList &pis) {
+    TRACE_SPAN("flipSim");
+    MEM_PHASE("sim");
+    if (_simValue.empty() || _simLevel.size() != Circuit.size()) {
+        cerr << "Error: circuit has not been simulated!!" << endl;
+        return;
+    }
+    typedef pair<unsigned, unsigned> LevelId;
+    priority_queue<LevelId, vector<LevelId>, greater<LevelId> > queue;
+    size_t evaluated = 0, changed = 0, poChanged = 0, full = 0;
+    for (size_t i = 0; i < _simLevel.size(); i++)
+        if (_simLevel[i] != 0) full++;
+
+    // a gate is marked once scheduled (AND) or counted (PO)
+    CirTravCtx &trav = CirTravCtx::forThread();
+    trav.begin(Circuit.size());
+    auto schedule = [&](unsigned id) {
+        const unsigned *f = Circuit.fanoutLit + Circuit.fanoutOfs[id];
+        for (unsigned k = 0, n = Circuit.getFanoutNum(id); k < n; k++) {
+            CirGate g(&Circuit, f[k] / 2);
+            if (trav.isMarked(g.getId())) continue;
+            if (g.getType() == PO_GATE)
+                poChanged++;
+            else if (_simLevel[g.getId()] == 0)
+                continue;  // not simulated, outside the DFS list
+            else
+                queue.push(LevelId(_simLevel[g.getId()], g.getId()));
+            trav.mark(g.getId());
+        }
+    };
+    for (size_t i = 0; i < pis.size(); i++) {
+        uint64_t *v = &_simValue[pis[i] * SIM_WORDS];
+        for (unsigned k = 0; k < SIM_WORDS; k++) v[k] = ~v[k];
+        schedule(pis[i]);
+    }
+    uint64_t *sim = &_simValue[0];
+    while (!queue.empty()) {
+        unsigned id = queue.top().second;
+        queue.pop();
+        evaluated++;
+        const unsigned *c = Circuit.fanin + id * 2;
+        const uint64_t *a = sim + (c[0] / 2) * SIM_WORDS;
+        const uint64_t *b = sim + (c[1] / 2) * SIM_WORDS;
+        const uint64_t ma = (c[0] & 1) ? ~uint64_t(0) : 0;
+        const uint64_t mb = (c[1] & 1) ? ~uint64_t(0) : 0;
+        uint64_t *o = sim + id * SIM_WORDS, diff = 0;
+        for (unsigned k = 0; k < SIM_WORDS; k++) {
+            uint64_t w = (a[k] ^ ma) & (b[k] ^ mb);
+            diff |= w ^ o[k];
+            o[k] = w;
+        }
+        if (diff == 0) continue;
+        changed++;
+        schedule(id);
+    }
+    cout << pis.size() << " PI(s) flipped: " << evaluated << " of " << full
+         << " ANDs evaluated (" << setprecision(3)
+         << (full ? 100.0 * evaluated / full : 0.0) << "%), " << changed
+         << " changed, " << poChanged << " PO(s) changed." << endl;
+    cout << setprecision(6);
+}
+
+/*************************************************/
+/*   Private member functions about Simulation   */
+// One FEC group holding CONST 0 and every AND in the DFS list. A member
+// is stored as a literal whose phase is the gate's first simulated bit,
+// so a signature and its complement fall into the same group.
+void CirMgr::initFecGroups(const uint64_t *sim) {
+    TRACE_SPAN("initFecGroups");
+    const vector<unsigned> &dfs = getDfsList();
+    _fecGroups.assign(1, IdList(1, 0));
+    for (size_t i = 0; i < dfs.size(); i++)
+        if (Circuit.type[dfs[i]] == AIG_GATE)
+            _fecGroups[0].push_back(dfs[i] * 2 +
+                                    (sim[dfs[i] * SIM_WORDS] & 1));
+    _fecValid = true;
+}
+// Split every group of fecGroups by the block in sim, in linear time:
+// each member goes into an open-addressing table keyed on (old group,
+// phase-adjusted words) whose slots name the new groups. Groups left with
+// one member are dropped; member order within a group is kept.
+void CirMgr::refineFecGroups(vector<IdList> &fecGroups,
+                             const uint64_t *sim) const {
+    TRACE_SPAN("refineFecGroups");
+    size_t members = 0;
+    for (size_t g = 0; g < fecGroups.size(); g++)
+        members += fecGroups[g].size();
+    if (members == 0) return;
+    // a new group per member at worst; keep the load at 1/2 or below
+    size_t size = getHashSize(members);
+    while (size < members * 2) size = size * 2 + 1;
+    const unsigned EMPTY = ~0u;
+    vector<unsigned> table(size, EMPTY);
+    vector<IdList> next;
+    IdList parent;
+
+    for (size_t g = 0; g < fecGroups.size(); g++) {
+        const IdList &group = fecGroups[g];
+        for (size_t i = 0; i < group.size(); i++) {
+            const uint64_t *v = sim + (group[i] / 2) * SIM_WORDS;
+            const uint64_t m = (group[i] & 1) ? ~uint64_t(0) : 0;
+            uint64_t h = g;
+            for (unsigned k = 0; k < SIM_WORDS; k++)
+                h = (h ^ (v[k] ^ m)) * 0x9e3779b97f4a7c15ULL;
+            size_t slot = size_t((h ^ (h >> 29)) % size);
+            for (;; slot = (slot + 1 == size) ? 0 : slot + 1) {
+                unsigned ng = table[slot];
+                if (ng == EMPTY) {
+                    table[slot] = next.size();
+                    next.push_back(IdList(1, group[i]));
+                    parent.push_back(g);
+                    break;
+                }
+                if (parent[ng] != g) continue;
+                const unsigned rep = next[ng][0];
+                const uint64_t *r = sim + (rep / 2) * SIM_WORDS;
+                const uint64_t rm = (rep & 1) ? ~uint64_t(0) : 0;
+                unsigned k = 0;
+                while (k < SIM_WORDS && (r[k] ^ rm) == (v[k] ^ m)) k++;
+                if (k == SIM_WORDS) {
+                    next[ng].push_back(group[i]);
+                    break;
+                }
+            }
+        }
+    }
+    fecGroups.clear();
+    for (size_t i = 0; i < next.size(); i++)
+        if (next[i].size() > 1) {
+            fecGroups.push_back(IdList());
+            fecGroups.back().swap(next[i]);
+        }
+}
+/*************************************************/
+// Logic level of every gate id: an AND in the DFS list is one above its
+// higher fanin; PI, CONST, UNDEF, PO and ANDs outside the list are 0.
+void CirMgr::levelize(IdList &level) const {
+    const vector<unsigned> &dfs = getDfsList();
+    level.assign(Circuit.size(), 0);
+    for (size_t i = 0; i < dfs.size(); i++) {
+        if (Circuit.type[dfs[i]] != AIG_GATE) continue;
+        const unsigned *c = Circuit.fanin + dfs[i] * 2;
+        level[dfs[i]] = max(level[c[0] / 2], level[c[1] / 2]) + 1;
+    }
+}
+// (id, fanin0, fanin1) of every AND in the DFS list, in DFS order. With
+// levelEnd the triples are grouped by logic level instead, keeping DFS
+// order within a level; levelEnd[l] is the number of ANDs of level l + 1
+// and below.
+void CirMgr::buildSimProg(IdList &prog, IdList *levelEnd) const {
+    const vector<unsigned> &dfs = getDfsList();
+    IdList ands;
+    for (size_t i = 0; i < dfs.size(); i++)
+        if (Circuit.type[dfs[i]] == AIG_GATE) ands.push_back(dfs[i]);
+    if (levelEnd != 0) {
+        IdList level;
+        levelize(level);
+        levelEnd->clear();
+        for (size_t i = 0; i < ands.size(); i++) {
+            unsigned l = level[ands[i]];
+            if (levelEnd->size() < l) levelEnd->resize(l, 0);
+            (*levelEnd)[l - 1]++;
+        }
+        for (size_t l = 1; l < levelEnd->size(); l++)
+            (*levelEnd)[l] += (*levelEnd)[l - 1];
+        // counting sort by level, stable in DFS order
+        IdList sorted(ands.size());
+        IdList pos(levelEnd->size(), 0);
+        for (size_t l = 1; l < pos.size(); l++) pos[l] = (*levelEnd)[l - 1];
+        for (size_t i = 0; i < ands.size(); i++)
+            sorted[pos[level[ands[i]] - 1]++] = ands[i];
+        ands.swap(sorted);
+    }
+    prog.clear();
+    prog.reserve(ands.size() * 3);
+    for (size_t i = 0; i < ands.size(); i++) {
+        prog.push_back(ands[i]);
+        prog.push_back(Circuit.fanin[ands[i] * 2]);
+        prog.push_back(Circuit.fanin[ands[i] * 2 + 1]);
+    }
+}
+// Evaluate one block of SIM_WORDS words in sim for every AND of prog. PI
+// words must be set already; UNDEF and CONST gates stay 0. On more than
+// one thread prog must be levelized: the threads split each level and
+// meet at a barrier before the next one.
+void CirMgr::simulateBlock(uint64_t *sim, const IdList &prog,
+                           const IdList &levelEnd, MyThreadPool &pool) {
+    TRACE_SPAN("simulateBlock");
+    if (prog.empty()) return;
+    SimKernel kernel = bestSimKernel();
+    if (pool.size() == 1) {
+        kernel(sim, &prog[0], prog.size() / 3);
+        return;
+    }
+    pool.run([&](unsigned t) {
+        size_t b = 0;
+        for (size_t l = 0; l < levelEnd.size(); l++) {
+            size_t len = levelEnd[l] - b;
+            size_t lb = b + len * t / pool.size();
+            size_t le = b + len * (t + 1) / pool.size();
+            if (lb < le) kernel(sim, &prog[lb * 3], le - lb);
+            b = levelEnd[l];
+            pool.barrier();
+        }
+    });
+}
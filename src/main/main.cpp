@@ -23,7 +23,8 @@ extern bool initCirCmd();
 static void
 usage()
 {
-   cout << "Usage: cirTest [ -File < doFile > ]" << endl;
+   cout << "Usage: cirTest [ -File < doFile > ] [ -Trace < jsonFile > ]"
+        << endl;
 }
 
 static void
@@ -40,22 +41,26 @@ main(int argc, char** argv)
 
    ifstream dof;
 
-   if (argc == 3) {  // -file <doFile>
-      if (myStrNCmp("-File", argv[1], 2) == 0) {
-         if (!cmdMgr->openDofile(argv[2])) {
-            cerr << "Error: cannot open file \"" << argv[2] << "\"!!\n";
+   if (argc % 2 == 0) {
+      cerr << "Error: illegal number of argument (" << argc << ")!!\n";
+      myexit();
+   }
+   for (int i = 1; i < argc; i += 2) {
+      if (myStrNCmp("-File", argv[i], 2) == 0) {  // -file <doFile>
+         if (!cmdMgr->openDofile(argv[i + 1])) {
+            cerr << "Error: cannot open file \"" << argv[i + 1] << "\"!!\n";
             myexit();
          }
       }
+      else if (myStrNCmp("-Trace", argv[i], 2) == 0) {  // -trace <jsonFile>
+         if (!myTrace.start(argv[i + 1]))
+            myexit();
+      }
       else {
-         cerr << "Error: unknown argument \"" << argv[1] << "\"!!\n";
+         cerr << "Error: unknown argument \"" << argv[i] << "\"!!\n";
          myexit();
       }
    }
-   else if (argc != 1) {
-      cerr << "Error: illegal number of argument (" << argc << ")!!\n";
-      myexit();
-   }
 
    if (!initCommonCmd() || !initCirCmd())
       return 1;
@@ -65,6 +70,8 @@ main(int argc, char** argv)
       status = cmdMgr->execOneCmd();
       cout << endl;  // a blank line between each command
    }
+   myProfile.atExit();
+   myTrace.atExit();
 
    return 0;
 }
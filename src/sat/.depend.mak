@@ -0,0 +1 @@
+sat.o: sat.cpp sat.h
@@ -0,0 +1,517 @@
+/****************************************************************************
+  FileName     [ sat.cpp ]
+  PackageName  [ sat ]
+  Synopsis     [ Define the incremental CDCL SAT solver ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2010-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include "sat.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+enum
+{
+   SAT_RESTART_BASE  = 100,      // conflicts per Luby unit
+   SAT_MIN_LEARNTS   = 2000,
+   SAT_GLUE_LBD      = 2         // learnt clauses never deleted
+};
+static const double SAT_VAR_DECAY = 0.95;
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// i-th element (from 0) of the Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+static size_t
+luby(size_t i)
+{
+   size_t size = 1, seq = 0;
+   while (size < i + 1) { ++seq; size = 2 * size + 1; }
+   while (size - 1 != i) {
+      size = (size - 1) >> 1;
+      --seq;
+      i = i % size;
+   }
+   return size_t(1) << seq;
+}
+
+/**************************************/
+/*   class SatSolver member functions */
+/**************************************/
+const unsigned SatSolver::NO_REF;
+
+SatSolver::SatSolver()
+   : _ok(true), _qhead(0), _restricted(false), _varInc(1),
+     _maxLearnts(SAT_MIN_LEARNTS),
+     _nConflicts(0), _nDecisions(0), _nPropagations(0)
+{
+}
+
+unsigned
+SatSolver::newVar()
+{
+   unsigned v = _assign.size();
+   _assign.push_back(VAL_UNDEF);
+   _model.push_back(VAL_UNDEF);
+   _polarity.push_back(1);
+   _seen.push_back(0);
+   _decision.push_back(_restricted ? 0 : 1);
+   _level.push_back(0);
+   _reason.push_back(NO_REF);
+   _activity.push_back(0);
+   _heapPos.push_back(-1);
+   _watches.resize(2 * (v + 1));
+   heapInsert(v);
+   return v;
+}
+
+bool
+SatSolver::addClause(vector<unsigned>& lits)
+{
+   assert(decisionLevel() == 0);
+   if (!_ok) return false;
+   // drop duplicates and false literals; a tautology or a true literal
+   // satisfies the clause
+   sort(lits.begin(), lits.end());
+   size_t j = 0;
+   for (size_t i = 0; i < lits.size(); ++i) {
+      assert((lits[i] >> 1) < nVars());
+      if (value(lits[i]) == VAL_TRUE) return true;
+      if (j != 0 && lits[i] == (lits[j - 1] ^ 1)) return true;
+      if (value(lits[i]) == VAL_FALSE) continue;
+      if (j != 0 && lits[i] == lits[j - 1]) continue;
+      lits[j++] = lits[i];
+   }
+   lits.resize(j);
+   if (lits.empty()) return _ok = false;
+   if (lits.size() == 1) {
+      assign(lits[0], NO_REF);
+      return _ok = (propagate() == NO_REF);
+   }
+   unsigned ref = newClause(lits, false);
+   _clauses.push_back(ref);
+   attach(ref);
+   return true;
+}
+
+bool
+SatSolver::addClause(unsigned a)
+{
+   vector<unsigned> lits(1, a);
+   return addClause(lits);
+}
+
+bool
+SatSolver::addClause(unsigned a, unsigned b)
+{
+   vector<unsigned> lits(2);
+   lits[0] = a; lits[1] = b;
+   return addClause(lits);
+}
+
+bool
+SatSolver::addClause(unsigned a, unsigned b, unsigned c)
+{
+   vector<unsigned> lits(3);
+   lits[0] = a; lits[1] = b; lits[2] = c;
+   return addClause(lits);
+}
+
+// o = a & b:  (!o + a)(!o + b)(o + !a + !b)
+bool
+SatSolver::addAnd(unsigned o, unsigned a, unsigned b)
+{
+   return addClause(o ^ 1, a) && addClause(o ^ 1, b) &&
+          addClause(o, a ^ 1, b ^ 1);
+}
+
+void
+SatSolver::setDecisionVars(const vector<unsigned>& vars)
+{
+   assert(decisionLevel() == 0);
+   for (size_t i = 0; i < _heap.size(); ++i) _heapPos[_heap[i]] = -1;
+   _heap.clear();
+   if (_restricted)
+      for (size_t i = 0; i < _decisionVars.size(); ++i)
+         _decision[_decisionVars[i]] = 0;
+   _restricted = !vars.empty();
+   _decisionVars = vars;
+   if (!_restricted) {
+      for (unsigned v = 0; v < nVars(); ++v) {
+         _decision[v] = 1;
+         if (_assign[v] == VAL_UNDEF) heapInsert(v);
+      }
+      return;
+   }
+   for (size_t i = 0; i < vars.size(); ++i) _decision[vars[i]] = 1;
+   for (size_t i = 0; i < vars.size(); ++i)
+      if (_assign[vars[i]] == VAL_UNDEF) heapInsert(vars[i]);
+}
+
+// Restarts follow the Luby sequence. Learnt clauses and var activities
+// survive the call; the trail is always back at level 0 on return.
+SatResult
+SatSolver::solve(const vector<unsigned>& assumps, size_t conflictLimit)
+{
+   if (!_ok) return SAT_UNSAT;
+   size_t start = _nConflicts;
+   SatResult res = SAT_UNDEF;
+   for (size_t r = 0; res == SAT_UNDEF; ++r) {
+      size_t budget = luby(r) * SAT_RESTART_BASE;
+      if (conflictLimit != 0) {
+         size_t used = _nConflicts - start;
+         if (used >= conflictLimit) break;
+         budget = min(budget, conflictLimit - used);
+      }
+      res = search(budget, assumps);
+   }
+   backtrack(0);
+   return res;
+}
+
+/*********************************************/
+/*   class SatSolver private member functions */
+/*********************************************/
+// the reason of its first literal's current assignment
+bool
+SatSolver::locked(unsigned ref) const
+{
+   unsigned l = _mem[ref + 2];
+   return value(l) == VAL_TRUE && _reason[l >> 1] == ref;
+}
+
+unsigned
+SatSolver::newClause(const vector<unsigned>& lits, bool learnt)
+{
+   unsigned ref = _mem.size();
+   _mem.push_back((unsigned(lits.size()) << 2) | (learnt ? 1 : 0));
+   _mem.push_back(0);
+   _mem.insert(_mem.end(), lits.begin(), lits.end());
+   return ref;
+}
+
+void
+SatSolver::attach(unsigned ref)
+{
+   const unsigned* c = lits(ref);
+   _watches[c[0] ^ 1].push_back(Watch(ref, c[1]));
+   _watches[c[1] ^ 1].push_back(Watch(ref, c[0]));
+}
+
+void
+SatSolver::assign(unsigned lit, unsigned reason)
+{
+   unsigned v = lit >> 1;
+   assert(_assign[v] == VAL_UNDEF);
+   _assign[v] = (lit & 1) ? VAL_FALSE : VAL_TRUE;
+   _level[v] = decisionLevel();
+   _reason[v] = reason;
+   _trail.push_back(lit);
+}
+
+// Unit propagation over the trail; returns the conflicting clause, or
+// NO_REF. The literal a clause implies is moved to its first position.
+unsigned
+SatSolver::propagate()
+{
+   unsigned confl = NO_REF;
+   while (_qhead < _trail.size() && confl == NO_REF) {
+      unsigned p = _trail[_qhead++];
+      unsigned falseLit = p ^ 1;
+      vector<Watch>& ws = _watches[p];
+      size_t i = 0, j = 0, n = ws.size();
+      ++_nPropagations;
+      while (i < n) {
+         Watch w = ws[i++];
+         if (value(w._blocker) == VAL_TRUE) { ws[j++] = w; continue; }
+         unsigned* c = lits(w._ref);
+         if (c[0] == falseLit) { c[0] = c[1]; c[1] = falseLit; }
+         unsigned first = c[0];
+         w._blocker = first;
+         if (value(first) == VAL_TRUE) { ws[j++] = w; continue; }
+         bool moved = false;
+         for (unsigned k = 2, sz = size(w._ref); k < sz; ++k)
+            if (value(c[k]) != VAL_FALSE) {
+               c[1] = c[k]; c[k] = falseLit;
+               _watches[c[1] ^ 1].push_back(w);
+               moved = true;
+               break;
+            }
+         if (moved) continue;
+         ws[j++] = w;
+         if (value(first) == VAL_FALSE) {
+            confl = w._ref;
+            while (i < n) ws[j++] = ws[i++];
+         }
+         else assign(first, w._ref);
+      }
+      ws.resize(j);
+   }
+   if (confl != NO_REF) _qhead = _trail.size();
+   return confl;
+}
+
+// First-UIP conflict analysis into _learnt, asserting literal first and
+// a literal of the backtrack level second. Literals implied by the rest
+// of the clause are removed.
+void
+SatSolver::analyze(unsigned confl, unsigned& btLevel)
+{
+   _learnt.assign(1, 0);
+   unsigned pathC = 0, p = NO_REF;
+   size_t index = _trail.size();
+   do {
+      assert(confl != NO_REF);
+      const unsigned* c = lits(confl);
+      for (unsigned k = (p == NO_REF) ? 0 : 1, sz = size(confl); k < sz; ++k) {
+         unsigned v = c[k] >> 1;
+         if (_seen[v] || _level[v] == 0) continue;
+         bumpVar(v);
+         _seen[v] = 1;
+         if (_level[v] >= decisionLevel()) ++pathC;
+         else _learnt.push_back(c[k]);
+      }
+      while (!_seen[_trail[--index] >> 1]) ;
+      p = _trail[index];
+      confl = _reason[p >> 1];
+      _seen[p >> 1] = 0;
+      --pathC;
+   } while (pathC > 0);
+   _learnt[0] = p ^ 1;
+
+   _toClear.assign(_learnt.begin(), _learnt.end());
+   size_t j = 1;
+   for (size_t i = 1; i < _learnt.size(); ++i)
+      if (!redundant(_learnt[i])) _learnt[j++] = _learnt[i];
+   _learnt.resize(j);
+
+   btLevel = 0;
+   if (_learnt.size() > 1) {
+      size_t max = 1;
+      for (size_t i = 2; i < _learnt.size(); ++i)
+         if (_level[_learnt[i] >> 1] > _level[_learnt[max] >> 1]) max = i;
+      swap(_learnt[1], _learnt[max]);
+      btLevel = _level[_learnt[1] >> 1];
+   }
+   for (size_t i = 0; i < _toClear.size(); ++i) _seen[_toClear[i] >> 1] = 0;
+}
+
+// lit is implied by its reason, whose other literals are all in the
+// learnt clause or fixed at level 0
+bool
+SatSolver::redundant(unsigned lit) const
+{
+   unsigned r = _reason[lit >> 1];
+   if (r == NO_REF) return false;
+   const unsigned* c = &_mem[r + 2];
+   for (unsigned k = 1, sz = size(r); k < sz; ++k) {
+      unsigned v = c[k] >> 1;
+      if (!_seen[v] && _level[v] != 0) return false;
+   }
+   return true;
+}
+
+void
+SatSolver::backtrack(unsigned level)
+{
+   if (decisionLevel() <= level) return;
+   for (size_t i = _trail.size(); i-- > _trailLim[level]; ) {
+      unsigned v = _trail[i] >> 1;
+      _assign[v] = VAL_UNDEF;
+      _reason[v] = NO_REF;
+      _polarity[v] = _trail[i] & 1;
+      heapInsert(v);
+   }
+   _trail.resize(_trailLim[level]);
+   _trailLim.resize(level);
+   _qhead = _trail.size();
+}
+
+// the unassigned var of highest activity in its saved phase, or NO_REF
+unsigned
+SatSolver::pickBranch()
+{
+   while (!_heap.empty()) {
+      unsigned v = heapPop();
+      if (_assign[v] == VAL_UNDEF) return v * 2 + _polarity[v];
+   }
+   return NO_REF;
+}
+
+// Search until a model, a refutation, or budget conflicts (SAT_UNDEF).
+// Assumption i is decided at level i + 1; one found false makes the call
+// UNSAT without touching the clauses.
+SatResult
+SatSolver::search(size_t budget, const vector<unsigned>& assumps)
+{
+   for (size_t conflicts = 0; ; ) {
+      unsigned confl = propagate();
+      if (confl != NO_REF) {
+         ++_nConflicts; ++conflicts;
+         if (decisionLevel() == 0) { _ok = false; return SAT_UNSAT; }
+         unsigned btLevel;
+         analyze(confl, btLevel);
+         backtrack(btLevel);
+         if (_learnt.size() == 1) assign(_learnt[0], NO_REF);
+         else {
+            unsigned ref = newClause(_learnt, true);
+            // LBD: distinct decision levels in the clause
+            _toClear.clear();
+            for (size_t i = 0; i < _learnt.size(); ++i)
+               _toClear.push_back(_level[_learnt[i] >> 1]);
+            sort(_toClear.begin(), _toClear.end());
+            _mem[ref + 1] = unique(_toClear.begin(), _toClear.end()) -
+                            _toClear.begin();
+            _learnts.push_back(ref);
+            attach(ref);
+            assign(_learnt[0], ref);
+         }
+         _varInc /= SAT_VAR_DECAY;
+         continue;
+      }
+      if (conflicts >= budget) { backtrack(0); return SAT_UNDEF; }
+      if (_learnts.size() >= _maxLearnts + _trail.size()) reduceDB();
+
+      unsigned next = NO_REF;
+      while (decisionLevel() < assumps.size()) {
+         unsigned p = assumps[decisionLevel()];
+         if (value(p) == VAL_TRUE) _trailLim.push_back(_trail.size());
+         else if (value(p) == VAL_FALSE) return SAT_UNSAT;
+         else { next = p; break; }
+      }
+      if (next == NO_REF) {
+         next = pickBranch();
+         if (next == NO_REF) {
+            _model = _assign;
+            return SAT_SAT;
+         }
+         ++_nDecisions;
+      }
+      _trailLim.push_back(_trail.size());
+      assign(next, NO_REF);
+   }
+}
+
+// Delete about half of the learnt clauses, those of highest LBD first.
+// Glue clauses and the reasons of current assignments are kept.
+void
+SatSolver::reduceDB()
+{
+   vector<pair<unsigned, unsigned> > order;   // (LBD, ref)
+   order.reserve(_learnts.size());
+   for (size_t i = 0; i < _learnts.size(); ++i)
+      order.push_back(make_pair(_mem[_learnts[i] + 1], _learnts[i]));
+   sort(order.begin(), order.end());
+   size_t target = order.size() / 2;
+   for (size_t i = order.size(); i-- > 0 && target > 0; ) {
+      unsigned ref = order[i].second;
+      if (order[i].first <= SAT_GLUE_LBD) break;
+      if (size(ref) == 2 || locked(ref)) continue;
+      _mem[ref] |= 2;
+      --target;
+   }
+   collectGarbage();
+   _maxLearnts += _maxLearnts / 10;
+}
+
+// Compact the clause store after deletions: copy the live clauses, then
+// redirect the reasons and rebuild every watch list. The watched
+// literals keep their positions, so the watch invariant still holds.
+void
+SatSolver::collectGarbage()
+{
+   vector<unsigned> mem;
+   mem.reserve(_mem.size());
+   for (int pass = 0; pass < 2; ++pass) {
+      vector<unsigned>& list = pass ? _learnts : _clauses;
+      size_t j = 0;
+      for (size_t i = 0; i < list.size(); ++i) {
+         unsigned ref = list[i];
+         if (_mem[ref] & 2) continue;
+         unsigned to = mem.size();
+         mem.insert(mem.end(), _mem.begin() + ref,
+                    _mem.begin() + ref + 2 + size(ref));
+         _mem[ref + 1] = to;       // forward address, old store only
+         list[j++] = to;
+      }
+      list.resize(j);
+   }
+   for (size_t i = 0; i < _trail.size(); ++i) {
+      unsigned& r = _reason[_trail[i] >> 1];
+      if (r != NO_REF) r = _mem[r + 1];
+   }
+   _mem.swap(mem);
+   for (size_t l = 0; l < _watches.size(); ++l) _watches[l].clear();
+   for (size_t i = 0; i < _clauses.size(); ++i) attach(_clauses[i]);
+   for (size_t i = 0; i < _learnts.size(); ++i) attach(_learnts[i]);
+}
+
+void
+SatSolver::bumpVar(unsigned var)
+{
+   if ((_activity[var] += _varInc) > 1e100) {
+      for (size_t i = 0; i < _activity.size(); ++i) _activity[i] *= 1e-100;
+      _varInc *= 1e-100;
+   }
+   if (_heapPos[var] >= 0) heapUp(_heapPos[var]);
+}
+
+void
+SatSolver::heapUp(unsigned pos)
+{
+   unsigned v = _heap[pos];
+   while (pos > 0) {
+      unsigned parent = (pos - 1) >> 1;
+      if (_activity[_heap[parent]] >= _activity[v]) break;
+      _heap[pos] = _heap[parent];
+      _heapPos[_heap[pos]] = pos;
+      pos = parent;
+   }
+   _heap[pos] = v;
+   _heapPos[v] = pos;
+}
+
+void
+SatSolver::heapDown(unsigned pos)
+{
+   unsigned v = _heap[pos];
+   size_t n = _heap.size();
+   while (2 * pos + 1 < n) {
+      unsigned child = 2 * pos + 1;
+      if (child + 1 < n && _activity[_heap[child + 1]] > _activity[_heap[child]])
+         ++child;
+      if (_activity[_heap[child]] <= _activity[v]) break;
+      _heap[pos] = _heap[child];
+      _heapPos[_heap[pos]] = pos;
+      pos = child;
+   }
+   _heap[pos] = v;
+   _heapPos[v] = pos;
+}
+
+void
+SatSolver::heapInsert(unsigned var)
+{
+   if (_heapPos[var] >= 0 || !_decision[var]) return;
+   _heap.push_back(var);
+   heapUp(_heap.size() - 1);
+}
+
+unsigned
+SatSolver::heapPop()
+{
+   unsigned v = _heap[0];
+   _heapPos[v] = -1;
+   if (_heap.size() > 1) {
+      _heap[0] = _heap.back();
+      _heap.pop_back();
+      heapDown(0);
+   }
+   else _heap.pop_back();
+   return v;
+}
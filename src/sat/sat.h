@@ -0,0 +1,135 @@
+/****************************************************************************
+  FileName     [ sat.h ]
+  PackageName  [ sat ]
+  Synopsis     [ Define the incremental CDCL SAT solver ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2010-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef SAT_H
+#define SAT_H
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+enum SatResult
+{
+   SAT_UNSAT = 0,
+   SAT_SAT   = 1,
+   SAT_UNDEF = 2     // gave up at the conflict limit
+};
+
+// A conflict-driven clause-learning solver for incremental use: clauses
+// may be added between solve() calls, and every call may make a list of
+// literals true by assumption. Learnt clauses are kept across calls.
+//
+// A literal is var * 2 + sign, the same convention as the AIG literals;
+// sign 1 is the negation. The solver uses two watched literals with a
+// blocker, first-UIP learning with clause minimization, VSIDS decisions
+// with phase saving, Luby restarts and LBD-based clause deletion.
+class SatSolver
+{
+public:
+   SatSolver();
+
+   unsigned newVar();
+   unsigned nVars() const { return _assign.size(); }
+   // all return false once the clauses are unsatisfiable on their own;
+   // clauses can only be added between solve() calls
+   bool addClause(vector<unsigned>& lits);
+   bool addClause(unsigned a);
+   bool addClause(unsigned a, unsigned b);
+   bool addClause(unsigned a, unsigned b, unsigned c);
+   // Tseitin clauses of the AND gate o = a & b, all literals
+   bool addAnd(unsigned o, unsigned a, unsigned b);
+
+   // only vars of the list are decided on from now on, an empty list
+   // lifts the restriction. Any var left undecided must be implied by
+   // the decided ones, e.g. the Tseitin output of a gate in their cone.
+   void setDecisionVars(const vector<unsigned>& vars);
+
+   // satisfiable with every literal of assumps true? conflictLimit > 0
+   // bounds the conflicts of this call, after which SAT_UNDEF is returned
+   SatResult solve(const vector<unsigned>& assumps, size_t conflictLimit = 0);
+   // value of var in the model of the last SAT_SAT solve()
+   bool getValue(unsigned var) const { return _model[var] == 1; }
+
+   size_t nConflicts() const { return _nConflicts; }
+   size_t nDecisions() const { return _nDecisions; }
+   size_t nPropagations() const { return _nPropagations; }
+
+private:
+   static const unsigned NO_REF = ~0u;
+   enum { VAL_FALSE = 0, VAL_TRUE = 1, VAL_UNDEF = 2 };
+
+   // a watcher of clause ref; the clause is satisfied if blocker is true
+   struct Watch {
+      Watch(unsigned r = 0, unsigned b = 0) : _ref(r), _blocker(b) {}
+      unsigned    _ref;
+      unsigned    _blocker;
+   };
+
+   bool                    _ok;
+   // clause store: a clause at ref r is a header word (size << 2 |
+   // deleted << 1 | learnt), its LBD and then its literals
+   vector<unsigned>        _mem;
+   vector<unsigned>        _clauses;
+   vector<unsigned>        _learnts;
+   // indexed by literal p: clauses watching ~p, visited when p is assigned
+   vector<vector<Watch> >  _watches;
+   // per var
+   vector<unsigned char>   _assign;
+   vector<unsigned char>   _model;
+   vector<unsigned char>   _polarity;
+   vector<unsigned char>   _seen;
+   vector<unsigned char>   _decision;
+   vector<unsigned>        _level;
+   vector<unsigned>        _reason;
+   vector<double>          _activity;
+   vector<int>             _heapPos;
+   // max-heap of unassigned vars by activity
+   vector<unsigned>        _heap;
+   vector<unsigned>        _trail;
+   vector<unsigned>        _trailLim;
+   size_t                  _qhead;
+   bool                    _restricted;
+   vector<unsigned>        _decisionVars;
+   double                  _varInc;
+   size_t                  _maxLearnts;
+   size_t                  _nConflicts;
+   size_t                  _nDecisions;
+   size_t                  _nPropagations;
+   vector<unsigned>        _learnt;
+   vector<unsigned>        _toClear;
+
+   unsigned value(unsigned lit) const {
+      unsigned v = _assign[lit >> 1];
+      return v == VAL_UNDEF ? v : v ^ (lit & 1);
+   }
+   unsigned decisionLevel() const { return _trailLim.size(); }
+   unsigned size(unsigned ref) const { return _mem[ref] >> 2; }
+   bool isLearnt(unsigned ref) const { return _mem[ref] & 1; }
+   unsigned* lits(unsigned ref) { return &_mem[ref + 2]; }
+   bool locked(unsigned ref) const;
+
+   unsigned newClause(const vector<unsigned>& lits, bool learnt);
+   void attach(unsigned ref);
+   void assign(unsigned lit, unsigned reason);
+   unsigned propagate();
+   void analyze(unsigned confl, unsigned& btLevel);
+   bool redundant(unsigned lit) const;
+   void backtrack(unsigned level);
+   unsigned pickBranch();
+   SatResult search(size_t budget, const vector<unsigned>& assumps);
+   void reduceDB();
+   void collectGarbage();
+
+   void bumpVar(unsigned var);
+   void heapUp(unsigned pos);
+   void heapDown(unsigned pos);
+   void heapInsert(unsigned var);
+   unsigned heapPop();
+};
+
+#endif // SAT_H
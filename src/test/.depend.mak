@@ -0,0 +1 @@
+satTest.o: satTest.cpp ../../include/sat.h
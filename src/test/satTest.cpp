@@ -0,0 +1,269 @@
+/****************************************************************************
+  FileName     [ satTest.cpp ]
+  PackageName  [ test ]
+  Synopsis     [ Define main() of the SAT solver tests ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2010-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include "sat.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Test instances
+//----------------------------------------------------------------------
+// Every case builds its clauses, checks each solve() against the known
+// answer and every SAT model against the clauses, and returns whether
+// all of it held.
+typedef vector<vector<unsigned> > Cnf;
+
+static unsigned
+lit(unsigned var, bool neg = false)
+{
+   return var * 2 + (neg ? 1 : 0);
+}
+
+// adds the clauses of cnf to s, with vars 0 .. nVars - 1
+static bool
+load(SatSolver& s, unsigned nVars, Cnf& cnf)
+{
+   while (s.nVars() < nVars) s.newVar();
+   bool ok = true;
+   for (size_t i = 0; i < cnf.size(); ++i)
+      if (!s.addClause(cnf[i])) ok = false;
+   return ok;
+}
+
+static bool
+satisfies(const SatSolver& s, const Cnf& cnf)
+{
+   for (size_t i = 0; i < cnf.size(); ++i) {
+      bool sat = false;
+      for (size_t j = 0; j < cnf[i].size() && !sat; ++j)
+         sat = s.getValue(cnf[i][j] / 2) != (cnf[i][j] & 1);
+      if (!sat) return false;
+   }
+   return true;
+}
+
+static bool
+expect(SatSolver& s, const Cnf& cnf, const vector<unsigned>& assumps,
+       SatResult want, size_t conflictLimit = 0)
+{
+   SatResult r = s.solve(assumps, conflictLimit);
+   if (r != want) return false;
+   if (r != SAT_SAT) return true;
+   for (size_t i = 0; i < assumps.size(); ++i)
+      if (s.getValue(assumps[i] / 2) == (assumps[i] & 1)) return false;
+   return satisfies(s, cnf);
+}
+
+// pigeon p sits in hole h: var p * holes + h
+static Cnf
+pigeonHole(unsigned pigeons, unsigned holes)
+{
+   Cnf cnf;
+   for (unsigned p = 0; p < pigeons; ++p) {
+      cnf.push_back(vector<unsigned>());
+      for (unsigned h = 0; h < holes; ++h)
+         cnf.back().push_back(lit(p * holes + h));
+   }
+   for (unsigned h = 0; h < holes; ++h)
+      for (unsigned p = 0; p < pigeons; ++p)
+         for (unsigned q = p + 1; q < pigeons; ++q) {
+            vector<unsigned> c(2);
+            c[0] = lit(p * holes + h, true);
+            c[1] = lit(q * holes + h, true);
+            cnf.push_back(c);
+         }
+   return cnf;
+}
+
+// nClauses random clauses of 3 distinct vars out of nVars, from seed
+static Cnf
+random3Sat(unsigned nVars, unsigned nClauses, unsigned seed)
+{
+   Cnf cnf(nClauses);
+   unsigned x = seed;
+   for (unsigned i = 0; i < nClauses; ++i)
+      while (cnf[i].size() < 3) {
+         x = x * 1103515245u + 12345u;
+         unsigned v = (x >> 8) % nVars;
+         bool dup = false;
+         for (size_t j = 0; j < cnf[i].size(); ++j)
+            dup = dup || cnf[i][j] / 2 == v;
+         if (!dup) cnf[i].push_back(lit(v, (x >> 4) & 1));
+      }
+   return cnf;
+}
+
+static bool
+testEmpty()
+{
+   SatSolver s;
+   Cnf cnf;
+   load(s, 3, cnf);
+   return expect(s, cnf, vector<unsigned>(), SAT_SAT);
+}
+
+static bool
+testUnit()
+{
+   SatSolver s;
+   Cnf cnf(2, vector<unsigned>(1));
+   cnf[0][0] = lit(0);
+   cnf[1][0] = lit(0, true);
+   return !load(s, 1, cnf) && expect(s, cnf, vector<unsigned>(), SAT_UNSAT);
+}
+
+// o = a & b; assumptions switch the answer without new clauses
+static bool
+testAnd()
+{
+   SatSolver s;
+   const unsigned a = s.newVar(), b = s.newVar(), o = s.newVar();
+   if (!s.addAnd(lit(o), lit(a), lit(b))) return false;
+   Cnf cnf;
+   vector<unsigned> as(1, lit(o));
+   if (!expect(s, cnf, as, SAT_SAT)) return false;
+   if (!s.getValue(a) || !s.getValue(b)) return false;
+   as.push_back(lit(a, true));
+   if (!expect(s, cnf, as, SAT_UNSAT)) return false;
+   as.assign(1, lit(o, true));
+   as.push_back(lit(a));
+   if (!expect(s, cnf, as, SAT_SAT) || s.getValue(b)) return false;
+   // a clause added later is kept by the next calls
+   s.addClause(lit(b));
+   return expect(s, cnf, as, SAT_UNSAT) &&
+          expect(s, cnf, vector<unsigned>(1, lit(o)), SAT_SAT);
+}
+
+// x0 ^ x1 ^ ... ^ x(n-1) as a chain of Tseitin ANDs; the parity cannot
+// be both 0 and 1
+static bool
+testParity()
+{
+   const unsigned n = 16;
+   SatSolver s;
+   vector<unsigned> x(n);
+   for (unsigned i = 0; i < n; ++i) x[i] = lit(s.newVar());
+   unsigned acc = x[0];
+   for (unsigned i = 1; i < n; ++i) {
+      // acc ^ x = !(!(acc & !x) & !(!acc & x))
+      unsigned p = lit(s.newVar()), q = lit(s.newVar()), r = lit(s.newVar());
+      s.addAnd(p, acc, x[i] ^ 1);
+      s.addAnd(q, acc ^ 1, x[i]);
+      s.addAnd(r, p ^ 1, q ^ 1);
+      acc = r ^ 1;
+   }
+   Cnf cnf;
+   vector<unsigned> as(1, acc);
+   if (!expect(s, cnf, as, SAT_SAT)) return false;
+   unsigned ones = 0;
+   for (unsigned i = 0; i < n; ++i) ones += s.getValue(x[i] / 2);
+   if (ones % 2 != 1) return false;
+   as.push_back(x[0]);
+   as.push_back(x[1]);
+   return expect(s, cnf, as, SAT_SAT) && s.addClause(acc ^ 1) &&
+          expect(s, cnf, vector<unsigned>(1, acc), SAT_UNSAT);
+}
+
+static bool
+testPigeonHole()
+{
+   for (unsigned n = 2; n <= 6; ++n) {
+      Cnf fit = pigeonHole(n, n), over = pigeonHole(n + 1, n);
+      SatSolver s, t;
+      load(s, n * n, fit);
+      load(t, (n + 1) * n, over);
+      if (!expect(s, fit, vector<unsigned>(), SAT_SAT)) return false;
+      if (!expect(t, over, vector<unsigned>(), SAT_UNSAT)) return false;
+   }
+   return true;
+}
+
+// a conflict limit gives up; the same solver still finishes afterwards
+static bool
+testLimit()
+{
+   Cnf over = pigeonHole(7, 6);
+   SatSolver s;
+   load(s, 7 * 6, over);
+   return expect(s, over, vector<unsigned>(), SAT_UNDEF, 1) &&
+          expect(s, over, vector<unsigned>(), SAT_UNSAT);
+}
+
+// only the listed vars are decided on; the Tseitin outputs follow
+static bool
+testDecisionVars()
+{
+   SatSolver s;
+   const unsigned a = s.newVar(), b = s.newVar(), c = s.newVar();
+   const unsigned ab = s.newVar(), o = s.newVar();
+   s.addAnd(lit(ab), lit(a), lit(b));
+   s.addAnd(lit(o), lit(ab), lit(c, true));
+   vector<unsigned> vars(1, a);
+   vars.push_back(b);
+   vars.push_back(c);
+   s.setDecisionVars(vars);
+   Cnf cnf;
+   if (!expect(s, cnf, vector<unsigned>(1, lit(o)), SAT_SAT)) return false;
+   if (!s.getValue(a) || !s.getValue(b) || s.getValue(c)) return false;
+   vector<unsigned> as(1, lit(o));
+   as.push_back(lit(c));
+   if (!expect(s, cnf, as, SAT_UNSAT)) return false;
+   s.setDecisionVars(vector<unsigned>());
+   return expect(s, cnf, vector<unsigned>(1, lit(o, true)), SAT_SAT);
+}
+
+// 3-SAT at 3 clauses per var is satisfiable, at 8 it is not
+static bool
+testRandom()
+{
+   for (unsigned seed = 1; seed <= 4; ++seed) {
+      Cnf easy = random3Sat(60, 180, seed), hard = random3Sat(60, 480, seed);
+      SatSolver s, t;
+      load(s, 60, easy);
+      load(t, 60, hard);
+      if (!expect(s, easy, vector<unsigned>(), SAT_SAT)) return false;
+      if (!expect(t, hard, vector<unsigned>(), SAT_UNSAT)) return false;
+   }
+   return true;
+}
+
+struct SatTest
+{
+   const char*   _name;
+   bool          (*_run)();
+};
+
+static const SatTest satTests[] = {
+   { "empty",         testEmpty },
+   { "unit",          testUnit },
+   { "and",           testAnd },
+   { "parity",        testParity },
+   { "pigeonHole",    testPigeonHole },
+   { "limit",         testLimit },
+   { "decisionVars",  testDecisionVars },
+   { "random3Sat",    testRandom }
+};
+
+//----------------------------------------------------------------------
+//    main()
+//----------------------------------------------------------------------
+int
+main()
+{
+   const size_t n = sizeof(satTests) / sizeof(satTests[0]);
+   size_t passed = 0;
+   for (size_t i = 0; i < n; ++i) {
+      bool ok = satTests[i]._run();
+      cout << satTests[i]._name << ": " << (ok ? "ok" : "FAILED") << endl;
+      if (ok) ++passed;
+   }
+   cout << passed << " of " << n << " SAT tests passed" << endl;
+   return passed == n ? 0 : 1;
+}
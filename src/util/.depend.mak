@@ -1,3 +1,6 @@
 myGetChar.o: myGetChar.cpp
+myMemStat.o: myMemStat.cpp myMemStat.h
+myProfile.o: myProfile.cpp myProfile.h
 myString.o: myString.cpp
-util.o: util.cpp rnGen.h myUsage.h
+myTrace.o: myTrace.cpp myTrace.h
+util.o: util.cpp rnGen.h myUsage.h myProfile.h myTrace.h
@@ -1,4 +1,4 @@
-util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h 
+util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h ../../include/myArena.h ../../include/myThreadPool.h ../../include/myOutBuf.h ../../include/myProfile.h ../../include/myTrace.h ../../include/myMemStat.h 
 ../../include/util.h: util.h
 	@rm -f ../../include/util.h
 	@ln -fs ../src/util/util.h ../../include/util.h
@@ -8,3 +8,21 @@ util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h
 ../../include/myUsage.h: myUsage.h
 	@rm -f ../../include/myUsage.h
 	@ln -fs ../src/util/myUsage.h ../../include/myUsage.h
+../../include/myArena.h: myArena.h
+	@rm -f ../../include/myArena.h
+	@ln -fs ../src/util/myArena.h ../../include/myArena.h
+../../include/myThreadPool.h: myThreadPool.h
+	@rm -f ../../include/myThreadPool.h
+	@ln -fs ../src/util/myThreadPool.h ../../include/myThreadPool.h
+../../include/myOutBuf.h: myOutBuf.h
+	@rm -f ../../include/myOutBuf.h
+	@ln -fs ../src/util/myOutBuf.h ../../include/myOutBuf.h
+../../include/myProfile.h: myProfile.h
+	@rm -f ../../include/myProfile.h
+	@ln -fs ../src/util/myProfile.h ../../include/myProfile.h
+../../include/myTrace.h: myTrace.h
+	@rm -f ../../include/myTrace.h
+	@ln -fs ../src/util/myTrace.h ../../include/myTrace.h
+../../include/myMemStat.h: myMemStat.h
+	@rm -f ../../include/myMemStat.h
+	@ln -fs ../src/util/myMemStat.h ../../include/myMemStat.h
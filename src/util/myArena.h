@@ -0,0 +1,105 @@
+/****************************************************************************
+  FileName     [ myArena.h ]
+  PackageName  [ util ]
+  Synopsis     [ Bump allocator releasing all its memory at once ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_ARENA_H
+#define MY_ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// MyArena hands out memory from large blocks by bumping a pointer.
+// Nothing is freed individually; reset() or the destructor releases every
+// block together. Only use it for PODs, as no destructor is ever called.
+// A request larger than the block size gets a block of its own.
+class MyArena
+{
+public:
+   MyArena(size_t blockSize = 1 << 20)
+      : _blockSize(blockSize), _blocks(0), _cur(0), _end(0), _allocated(0) {}
+   ~MyArena() { reset(); }
+
+   // raw memory for n objects of T, not initialized
+   template<class T> T* alloc(size_t n) {
+      return static_cast<T*>(allocBytes(n * sizeof(T), alignof(T)));
+   }
+   // n zero-filled objects of T
+   template<class T> T* allocZero(size_t n) {
+      T* p = alloc<T>(n);
+      memset(p, 0, n * sizeof(T));
+      return p;
+   }
+   // copy of s[0..n) with a terminating '\0'
+   char* strdup(const char* s, size_t n) {
+      char* p = alloc<char>(n + 1);
+      memcpy(p, s, n);
+      p[n] = 0;
+      return p;
+   }
+   void reset() {
+      while (_blocks != 0) {
+         Block* next = _blocks->_next;
+         free(_blocks);
+         _blocks = next;
+      }
+      _cur = _end = 0;
+      _allocated = 0;
+   }
+   // bytes obtained from malloc, headers included
+   size_t getAllocated() const { return _allocated; }
+
+private:
+   // aligned so that the payload behind it suits any type
+   struct alignas(max_align_t) Block {
+      Block*   _next;
+   };
+
+   size_t   _blockSize;
+   Block*   _blocks;
+   char*    _cur;
+   char*    _end;
+   size_t   _allocated;
+
+   MyArena(const MyArena&);             // not copyable
+   MyArena& operator=(const MyArena&);
+
+   void* allocBytes(size_t bytes, size_t align) {
+      size_t pad = (align - (size_t(_cur) & (align - 1))) & (align - 1);
+      if (_cur == 0 || bytes + pad > size_t(_end - _cur)) {
+         if (bytes > _blockSize / 4) return newBlock(bytes, false);
+         newBlock(_blockSize, true);
+         pad = 0;
+      }
+      void* p = _cur + pad;
+      _cur += pad + bytes;
+      return p;
+   }
+   // a big request gets a private block linked behind the current one so
+   // that the remaining space of the current block is not wasted
+   char* newBlock(size_t bytes, bool makeCurrent) {
+      Block* b = static_cast<Block*>(malloc(sizeof(Block) + bytes));
+      if (b == 0) throw std::bad_alloc();
+      _allocated += sizeof(Block) + bytes;
+      char* payload = reinterpret_cast<char*>(b + 1);
+      if (makeCurrent || _blocks == 0) {
+         b->_next = _blocks;
+         _blocks = b;
+      }
+      else {
+         b->_next = _blocks->_next;
+         _blocks->_next = b;
+      }
+      if (makeCurrent) {
+         _cur = payload;
+         _end = payload + bytes;
+      }
+      return payload;
+   }
+};
+
+#endif // MY_ARENA_H
@@ -0,0 +1,191 @@
+/****************************************************************************
+  FileName     [ myMemStat.cpp ]
+  PackageName  [ util ]
+  Synopsis     [ Define the allocation hooks and class MyMemStat ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include "myMemStat.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Phase counters
+//----------------------------------------------------------------------
+// Everything here is zero-initialized before any constructor runs, so
+// the hooks work for allocations made during static initialization too.
+enum MemStatSize
+{
+   MAX_PHASES = 32,     // phase 0 is "other"; later names share the last
+};
+
+struct MemPhase
+{
+   const char*      _name;
+   atomic<size_t>   _allocs;
+   atomic<size_t>   _frees;
+   atomic<size_t>   _bytes;
+   atomic<size_t>   _live;     // of the allocations made in this phase
+   atomic<size_t>   _peak;     // of all live bytes, while current
+};
+
+static MemPhase          memPhase[MAX_PHASES];
+static unsigned          nMemPhases = 1;
+static mutex             memPhaseMutex;     // guards the phase names
+static atomic<unsigned>  curMemPhase;
+static atomic<size_t>    memLive;
+static atomic<size_t>    memPeak;
+
+static void
+raiseTo(atomic<size_t>& m, size_t x)
+{
+   size_t old = m.load(memory_order_relaxed);
+   while (old < x && !m.compare_exchange_weak(old, x, memory_order_relaxed))
+      ;
+}
+
+#ifdef CIR_MEMSTAT
+//----------------------------------------------------------------------
+//    Global operator new and delete
+//----------------------------------------------------------------------
+// Every block starts with a header holding its size and phase; the
+// header keeps the payload aligned as malloc() would.
+struct alignas(max_align_t) MemHeader
+{
+   size_t     _size;
+   unsigned   _phase;
+};
+
+static void*
+countedAlloc(size_t n)
+{
+   MemHeader* h = static_cast<MemHeader*>(malloc(sizeof(MemHeader) + n));
+   if (h == 0) return 0;
+   unsigned p = curMemPhase.load(memory_order_relaxed);
+   h->_size = n;
+   h->_phase = p;
+   MemPhase& ph = memPhase[p];
+   ph._allocs.fetch_add(1, memory_order_relaxed);
+   ph._bytes.fetch_add(n, memory_order_relaxed);
+   ph._live.fetch_add(n, memory_order_relaxed);
+   size_t live = memLive.fetch_add(n, memory_order_relaxed) + n;
+   raiseTo(ph._peak, live);
+   raiseTo(memPeak, live);
+   return h + 1;
+}
+
+static void
+countedFree(void* p)
+{
+   if (p == 0) return;
+   MemHeader* h = static_cast<MemHeader*>(p) - 1;
+   MemPhase& ph = memPhase[h->_phase];
+   ph._frees.fetch_add(1, memory_order_relaxed);
+   ph._live.fetch_sub(h->_size, memory_order_relaxed);
+   memLive.fetch_sub(h->_size, memory_order_relaxed);
+   free(h);
+}
+
+void* operator new(size_t n)
+{
+   void* p = countedAlloc(n);
+   if (p == 0) throw bad_alloc();
+   return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void* operator new(size_t n, const nothrow_t&) noexcept
+{ return countedAlloc(n); }
+void* operator new[](size_t n, const nothrow_t&) noexcept
+{ return countedAlloc(n); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept
+{ countedFree(p); }
+#endif // CIR_MEMSTAT
+
+//----------------------------------------------------------------------
+//    Member functions of class MyMemStat
+//----------------------------------------------------------------------
+bool
+MyMemStat::isOn()
+{
+#ifdef CIR_MEMSTAT
+   return true;
+#else
+   return false;
+#endif
+}
+
+// Phases are found by name. Concurrent queries may enter phases, but the
+// one current phase then belongs to whichever entered last.
+unsigned
+MyMemStat::enter(const char* name)
+{
+   lock_guard<mutex> lock(memPhaseMutex);
+   unsigned p = 1;
+   while (p < nMemPhases && strcmp(memPhase[p]._name, name) != 0) ++p;
+   if (p == nMemPhases) {
+      if (nMemPhases < MAX_PHASES) memPhase[nMemPhases++]._name = name;
+      else p = MAX_PHASES - 1;
+   }
+   raiseTo(memPhase[p]._peak, memLive.load(memory_order_relaxed));
+   return curMemPhase.exchange(p);
+}
+
+void
+MyMemStat::leave(unsigned prev)
+{
+   curMemPhase.store(prev);
+}
+
+size_t
+MyMemStat::getLive()
+{
+   return memLive.load();
+}
+
+size_t
+MyMemStat::getPeak()
+{
+   return memPeak.load();
+}
+
+/*********************************************************************
+Phase            Allocs      Frees   Alloc(MB)  Retain(MB)   Peak(MB)
+parse               120         80       12.34        8.00      20.10
+*********************************************************************/
+void
+MyMemStat::report()
+{
+   lock_guard<mutex> lock(memPhaseMutex);
+   if (!isOn()) {
+      cout << "Allocation counting is not compiled in; rebuild with "
+           << "\"make MEMSTAT=1\"" << endl;
+      return;
+   }
+   const double mb = 1 << 20;
+   cout << left << setw(12) << "Phase" << right << setw(11) << "Allocs"
+        << setw(11) << "Frees" << setw(12) << "Alloc(MB)" << setw(12)
+        << "Retain(MB)" << setw(11) << "Peak(MB)" << endl
+        << fixed << setprecision(2);
+   for (unsigned p = 0; p < nMemPhases; ++p) {
+      const MemPhase& ph = memPhase[p];
+      cout << left << setw(12) << (p ? ph._name : "other") << right
+           << setw(11) << ph._allocs.load() << setw(11) << ph._frees.load()
+           << setw(12) << ph._bytes.load() / mb << setw(12)
+           << ph._live.load() / mb << setw(11) << ph._peak.load() / mb
+           << endl;
+   }
+   cout << "Live: " << getLive() / mb << " MB, peak: " << getPeak() / mb
+        << " MB" << endl;
+   cout.unsetf(ios::floatfield);
+   cout << setprecision(6);
+}
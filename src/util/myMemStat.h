@@ -0,0 +1,59 @@
+/****************************************************************************
+  FileName     [ myMemStat.h ]
+  PackageName  [ util ]
+  Synopsis     [ Count heap allocations per program phase ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_MEM_STAT_H
+#define MY_MEM_STAT_H
+
+#include <cstddef>
+
+using namespace std;
+
+// In a build with CIR_MEMSTAT defined (make MEMSTAT=1), myMemStat.cpp
+// replaces the global operator new and delete to count every allocation,
+// its bytes and the live bytes, and charges them to the phase that made
+// the allocation. MEM_PHASE(name) makes name the current phase for the
+// rest of the enclosing scope; phases nest, and allocations outside any
+// phase go to "other". There is one current phase for all threads, so
+// worker threads count towards the phase that started them. Memory from
+// malloc, such as MyArena blocks, is not seen. Without CIR_MEMSTAT the
+// macro is empty and report() only says so.
+#ifdef CIR_MEMSTAT
+#define MEM_PHASE(name) MyMemPhase _memPhase(name)
+#else
+#define MEM_PHASE(name) ((void)0)
+#endif
+
+class MyMemStat
+{
+public:
+   // the allocation hooks are compiled in
+   static bool isOn();
+   // make name the current phase; returns the phase it replaces
+   static unsigned enter(const char* name);
+   static void leave(unsigned prev);
+
+   // bytes allocated with new and not yet deleted
+   static size_t getLive();
+   static size_t getPeak();
+   // table of the phases on cout
+   static void report();
+};
+
+class MyMemPhase
+{
+public:
+   MyMemPhase(const char* name) : _prev(MyMemStat::enter(name)) {}
+   ~MyMemPhase() { MyMemStat::leave(_prev); }
+
+private:
+   unsigned   _prev;
+
+   MyMemPhase(const MyMemPhase&);            // not copyable
+   MyMemPhase& operator=(const MyMemPhase&);
+};
+
+#endif // MY_MEM_STAT_H
@@ -0,0 +1,126 @@
+/****************************************************************************
+  FileName     [ myOutBuf.h ]
+  PackageName  [ util ]
+  Synopsis     [ Buffered text writer with its own number formatting ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_OUT_BUF_H
+#define MY_OUT_BUF_H
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+// MyOutBuf collects text in one fixed buffer and hands it to an ostream
+// only when the buffer is full, on flush() and on destruction. Integers
+// are converted by hand, so writing allocates nothing and never touches
+// the stream's locale or format flags. '\n' does not flush; create one
+// writer per printout and let it go out of scope (or flush()) before the
+// same stream is written to directly.
+class MyOutBuf
+{
+public:
+   MyOutBuf(ostream& os, size_t bufSize = 1 << 16)
+      : _os(os), _buf(new char[bufSize]), _cur(_buf), _end(_buf + bufSize),
+        _drained(0) {}
+   ~MyOutBuf() { flush(); delete[] _buf; }
+
+   MyOutBuf& operator << (char c) {
+      if (_cur == _end) drain();
+      *_cur++ = c;
+      return *this;
+   }
+   MyOutBuf& operator << (const char* s) { return write(s, strlen(s)); }
+   MyOutBuf& operator << (const string& s) {
+      return write(s.data(), s.size());
+   }
+   MyOutBuf& operator << (int n) {
+      if (n < 0) {
+         *this << '-';
+         return putNum(0ull - (unsigned long long)n);
+      }
+      return putNum(n);
+   }
+   MyOutBuf& operator << (unsigned n) { return putNum(n); }
+   MyOutBuf& operator << (unsigned long n) { return putNum(n); }
+   MyOutBuf& operator << (unsigned long long n) { return putNum(n); }
+
+   // the same text as setw(width) << x with right (padLeft) or left
+   // (padRight) adjustment: spaces fill up to width, nothing is cut
+   MyOutBuf& padLeft(const char* s, size_t width) {
+      size_t n = strlen(s);
+      return fill(n, width).write(s, n);
+   }
+   MyOutBuf& padLeft(unsigned long long x, size_t width) {
+      char tmp[NUM_DIGITS];
+      size_t n = toDec(x, tmp);
+      return fill(n, width).write(tmp + NUM_DIGITS - n, n);
+   }
+   MyOutBuf& padRight(const char* s, size_t width) {
+      size_t n = strlen(s);
+      return write(s, n).fill(n, width);
+   }
+
+   // characters written since construction, e.g. to pad a line
+   size_t count() const { return _drained + (_cur - _buf); }
+   // everything written so far reaches the stream and is flushed there
+   void flush() { drain(); _os.flush(); }
+
+   MyOutBuf& write(const char* s, size_t n) {
+      if (n > size_t(_end - _cur)) {
+         drain();
+         // too large to be worth a copy
+         if (n > size_t(_end - _buf)) {
+            _os.write(s, n);
+            _drained += n;
+            return *this;
+         }
+      }
+      memcpy(_cur, s, n);
+      _cur += n;
+      return *this;
+   }
+
+private:
+   enum { NUM_DIGITS = 20 };   // of the largest unsigned long long
+
+   ostream&   _os;
+   char*      _buf;
+   char*      _cur;
+   char*      _end;
+   size_t     _drained;
+
+   MyOutBuf(const MyOutBuf&);          // not copyable
+   MyOutBuf& operator=(const MyOutBuf&);
+
+   void drain() {
+      _os.write(_buf, _cur - _buf);
+      _drained += _cur - _buf;
+      _cur = _buf;
+   }
+   // decimal digits of x at the end of tmp; returns how many
+   static size_t toDec(unsigned long long x, char* tmp) {
+      char* p = tmp + NUM_DIGITS;
+      do {
+         *--p = char('0' + x % 10);
+         x /= 10;
+      } while (x != 0);
+      return tmp + NUM_DIGITS - p;
+   }
+   MyOutBuf& putNum(unsigned long long x) {
+      char tmp[NUM_DIGITS];
+      size_t n = toDec(x, tmp);
+      return write(tmp + NUM_DIGITS - n, n);
+   }
+   // spaces that widen a field of n characters to width
+   MyOutBuf& fill(size_t n, size_t width) {
+      for (; n < width; ++n) *this << ' ';
+      return *this;
+   }
+};
+
+#endif // MY_OUT_BUF_H
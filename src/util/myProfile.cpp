@@ -0,0 +1,172 @@
+/****************************************************************************
+  FileName     [ myProfile.cpp ]
+  PackageName  [ util ]
+  Synopsis     [ Define member functions of class MyProfile ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#include <unistd.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "myProfile.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Static functions
+//----------------------------------------------------------------------
+// resident set size in MB: current from /proc, else the peak
+static double
+checkRss()
+{
+   FILE* f = fopen("/proc/self/statm", "r");
+   if (f != 0) {
+      long pages, resident;
+      int n = fscanf(f, "%ld %ld", &pages, &resident);
+      fclose(f);
+      if (n == 2) return resident * double(sysconf(_SC_PAGESIZE)) / (1 << 20);
+   }
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+   return usage.ru_maxrss / double(1 << 20); // bytes
+#else
+   return usage.ru_maxrss / double(1 << 10); // KBytes
+#endif
+}
+
+// s as the contents of a JSON string
+static void
+writeJsonStr(ostream& os, const string& s)
+{
+   for (size_t i = 0, n = s.size(); i < n; ++i) {
+      unsigned char c = s[i];
+      if (c == '"' || c == '\\') os << '\\' << c;
+      else if (c < 0x20) {
+         char buf[8];
+         snprintf(buf, sizeof(buf), "\\u%04x", c);
+         os << buf;
+      }
+      else os << c;
+   }
+}
+
+//----------------------------------------------------------------------
+//    Member functions of class MyProfile
+//----------------------------------------------------------------------
+MyProfile::Stamp
+MyProfile::now()
+{
+   Stamp s;
+   s._wall = chrono::duration<double>(
+                chrono::steady_clock::now().time_since_epoch()).count();
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+   s._cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+            usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+   s._rss = checkRss();
+   return s;
+}
+
+void
+MyProfile::record(const string& name, const string& options,
+                  const Stamp& before, const Stamp& after)
+{
+   size_t t = 0;
+   while (t < _totals.size() && _totals[t]._name != name) ++t;
+   if (t == _totals.size()) {
+      Total total = { name, 0, 0, 0, 0, 0, 0 };
+      _totals.push_back(total);
+   }
+   Call call = { t, options, after._wall - before._wall,
+                 after._cpu - before._cpu, before._rss, after._rss };
+   _calls.push_back(call);
+
+   Total& total = _totals[t];
+   ++total._calls;
+   total._wall += call._wall;
+   if (call._wall > total._maxWall) total._maxWall = call._wall;
+   total._cpu += call._cpu;
+   if (after._rss > total._maxRss) total._maxRss = after._rss;
+   total._rssGrowth += after._rss - before._rss;
+}
+
+/*********************************************************************
+Command          Calls    Wall(s)     Max(s)     CPU(s)  RSS(MB)   +RSS(MB)
+CIRRead              2     0.0123     0.0100     0.0120     12.3        8.1
+*********************************************************************/
+void
+MyProfile::report(bool calls) const
+{
+   cout << left << setw(15) << "Command" << right << setw(7) << "Calls"
+        << setw(11) << "Wall(s)" << setw(11) << "Max(s)" << setw(11)
+        << "CPU(s)" << setw(9) << "RSS(MB)" << setw(11) << "+RSS(MB)"
+        << endl << fixed;
+   for (size_t t = 0, n = _totals.size(); t < n; ++t) {
+      const Total& total = _totals[t];
+      cout << left << setw(15) << total._name << right << setw(7)
+           << total._calls << setprecision(4) << setw(11) << total._wall
+           << setw(11) << total._maxWall << setw(11) << total._cpu
+           << setprecision(1) << setw(9) << total._maxRss << setw(11)
+           << total._rssGrowth << endl;
+   }
+   if (calls) {
+      cout << endl;
+      for (size_t i = 0, n = _calls.size(); i < n; ++i) {
+         const Call& call = _calls[i];
+         cout << setw(5) << i + 1 << "  " << left << setw(15)
+              << _totals[call._total]._name << right << setprecision(4)
+              << setw(11) << call._wall << setw(11) << call._cpu
+              << setprecision(1) << setw(9) << call._rssBefore << " -> "
+              << setw(9) << call._rssAfter << "  " << call._options << endl;
+      }
+   }
+   cout.unsetf(ios::floatfield);
+   cout << setprecision(6);
+}
+
+bool
+MyProfile::writeJson(const string& fileName) const
+{
+   ofstream ofs(fileName.c_str());
+   if (!ofs) {
+      cerr << "Error: cannot open file \"" << fileName << "\"!!" << endl;
+      return false;
+   }
+   ofs << setprecision(6) << "{\n  \"commands\": [";
+   for (size_t t = 0, n = _totals.size(); t < n; ++t) {
+      const Total& total = _totals[t];
+      ofs << (t ? ",\n" : "\n") << "    {\"name\": \"";
+      writeJsonStr(ofs, total._name);
+      ofs << "\", \"calls\": " << total._calls
+          << ", \"wall_s\": " << total._wall
+          << ", \"max_wall_s\": " << total._maxWall
+          << ", \"cpu_s\": " << total._cpu
+          << ", \"max_rss_mb\": " << total._maxRss
+          << ", \"rss_growth_mb\": " << total._rssGrowth << "}";
+   }
+   ofs << "\n  ],\n  \"calls\": [";
+   for (size_t i = 0, n = _calls.size(); i < n; ++i) {
+      const Call& call = _calls[i];
+      ofs << (i ? ",\n" : "\n") << "    {\"name\": \"";
+      writeJsonStr(ofs, _totals[call._total]._name);
+      ofs << "\", \"options\": \"";
+      writeJsonStr(ofs, call._options);
+      ofs << "\", \"wall_s\": " << call._wall
+          << ", \"cpu_s\": " << call._cpu
+          << ", \"rss_before_mb\": " << call._rssBefore
+          << ", \"rss_after_mb\": " << call._rssAfter << "}";
+   }
+   ofs << "\n  ]\n}\n";
+   return true;
+}
+
+void
+MyProfile::atExit() const
+{
+   if (!_exitJson.empty()) writeJson(_exitJson);
+}
@@ -0,0 +1,70 @@
+/****************************************************************************
+  FileName     [ myProfile.h ]
+  PackageName  [ util ]
+  Synopsis     [ Collect the run time and memory of every command ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_PROFILE_H
+#define MY_PROFILE_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// MyProfile keeps the wall time, CPU time and resident memory of every
+// command it is told about, one record per call, and totals per command
+// name in order of first use. Memory is the current resident set size
+// where /proc/self/statm exists, the peak one elsewhere.
+class MyProfile
+{
+public:
+   // clocks and memory at one moment; seconds and MB
+   struct Stamp
+   {
+      double   _wall;
+      double   _cpu;
+      double   _rss;
+   };
+   static Stamp now();
+
+   // name ran with options from before to after
+   void record(const string& name, const string& options,
+               const Stamp& before, const Stamp& after);
+   void reset() { _totals.clear(); _calls.clear(); }
+
+   // table of the totals on cout, and of every call if calls is set
+   void report(bool calls) const;
+   bool writeJson(const string& fileName) const;
+   // writeJson() to fileName when the program ends, "" for never
+   void setExitJson(const string& fileName) { _exitJson = fileName; }
+   void atExit() const;
+
+private:
+   struct Total
+   {
+      string   _name;
+      size_t   _calls;
+      double   _wall;
+      double   _maxWall;
+      double   _cpu;
+      double   _maxRss;
+      double   _rssGrowth;
+   };
+   struct Call
+   {
+      size_t   _total;        // index into _totals
+      string   _options;
+      double   _wall;
+      double   _cpu;
+      double   _rssBefore;
+      double   _rssAfter;
+   };
+
+   vector<Total>   _totals;
+   vector<Call>    _calls;
+   string          _exitJson;
+};
+
+#endif // MY_PROFILE_H
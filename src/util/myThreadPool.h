@@ -0,0 +1,110 @@
+/****************************************************************************
+  FileName     [ myThreadPool.h ]
+  PackageName  [ util ]
+  Synopsis     [ Fork-join pool of persistent worker threads ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_THREAD_POOL_H
+#define MY_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// MyThreadPool(n) keeps n - 1 worker threads alive; run(job) calls job(t)
+// for every t in [0, n), job(0) on the calling thread, and returns when
+// all of them are done. Jobs may call barrier() to wait until all n jobs
+// of the same run() have reached it. run() is not reentrant. If the
+// system runs out of threads, the pool keeps the ones it got and size()
+// tells how many jobs a run() has.
+class MyThreadPool
+{
+public:
+   MyThreadPool(unsigned n = 1)
+      : _size(n < 1 ? 1 : n), _job(0), _runId(0), _running(0),
+        _arrived(0), _phase(0), _quit(false) {
+      _workers.reserve(_size - 1);
+      for (unsigned t = 1; t < _size; ++t) {
+         try { _workers.push_back(thread(&MyThreadPool::work, this, t)); }
+         catch (const system_error&) { _size = t; break; }
+      }
+   }
+   ~MyThreadPool() {
+      {
+         unique_lock<mutex> lock(_mutex);
+         _quit = true;
+      }
+      _wake.notify_all();
+      for (size_t i = 0; i < _workers.size(); ++i) _workers[i].join();
+   }
+
+   unsigned size() const { return _size; }
+   void run(const function<void(unsigned)>& job) {
+      if (_size == 1) { job(0); return; }
+      {
+         unique_lock<mutex> lock(_mutex);
+         _job = &job;
+         _running = _size - 1;
+         ++_runId;
+      }
+      _wake.notify_all();
+      job(0);
+      unique_lock<mutex> lock(_mutex);
+      while (_running != 0) _done.wait(lock);
+      _job = 0;
+   }
+   void barrier() {
+      if (_size == 1) return;
+      unique_lock<mutex> lock(_mutex);
+      unsigned phase = _phase;
+      if (++_arrived == _size) {
+         _arrived = 0;
+         ++_phase;
+         _barrier.notify_all();
+      }
+      else
+         while (phase == _phase) _barrier.wait(lock);
+   }
+
+private:
+   unsigned                         _size;
+   vector<thread>                   _workers;
+   const function<void(unsigned)>*  _job;
+   size_t                           _runId;
+   unsigned                         _running;
+   unsigned                         _arrived;
+   unsigned                         _phase;
+   bool                             _quit;
+   mutex                            _mutex;
+   condition_variable               _wake;
+   condition_variable               _done;
+   condition_variable               _barrier;
+
+   MyThreadPool(const MyThreadPool&);             // not copyable
+   MyThreadPool& operator=(const MyThreadPool&);
+
+   void work(unsigned t) {
+      size_t seen = 0;
+      while (true) {
+         const function<void(unsigned)>* job;
+         {
+            unique_lock<mutex> lock(_mutex);
+            while (!_quit && _runId == seen) _wake.wait(lock);
+            if (_quit) return;
+            seen = _runId;
+            job = _job;
+         }
+         (*job)(t);
+         unique_lock<mutex> lock(_mutex);
+         if (--_running == 0) _done.notify_one();
+      }
+   }
+};
+
+#endif // MY_THREAD_POOL_H
@@ -0,0 +1,85 @@
+/****************************************************************************
+  FileName     [ myTrace.cpp ]
+  PackageName  [ util ]
+  Synopsis     [ Define member functions of class MyTrace ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "myTrace.h"
+
+using namespace std;
+
+extern MyTrace myTrace;
+
+// trace thread id of this thread, 0 until its first span ends
+static thread_local unsigned traceTid = 0;
+
+//----------------------------------------------------------------------
+//    Member functions of class MyTrace
+//----------------------------------------------------------------------
+bool
+MyTrace::start(const string& fileName)
+{
+#ifndef CIR_TRACE
+   cerr << "Error: tracing is not compiled in; rebuild with "
+        << "\"make TRACE=1\"!!" << endl;
+   return false;
+#endif
+   // fail now rather than at exit
+   ofstream ofs(fileName.c_str());
+   if (!ofs) {
+      cerr << "Error: cannot open file \"" << fileName << "\"!!" << endl;
+      return false;
+   }
+   _fileName = fileName;
+   _on = true;
+   return true;
+}
+
+void
+MyTrace::add(const char* name, double begin, double end)
+{
+   lock_guard<mutex> lock(_mutex);
+   if (traceTid == 0) traceTid = ++_nThreads;
+   Event e = { name, begin, end - begin, traceTid };
+   _events.push_back(e);
+}
+
+// Complete events ("ph": "X") in the JSON object format; chrome://tracing
+// and Perfetto load the file as is.
+void
+MyTrace::atExit()
+{
+   if (!_on) return;
+   _on = false;
+   ofstream ofs(_fileName.c_str());
+   if (!ofs) {
+      cerr << "Error: cannot open file \"" << _fileName << "\"!!" << endl;
+      return;
+   }
+   ofs << fixed << setprecision(3) << "{\"traceEvents\": [";
+   for (size_t i = 0, n = _events.size(); i < n; ++i) {
+      const Event& e = _events[i];
+      // span names are identifiers; nothing to escape
+      ofs << (i ? ",\n" : "\n") << "{\"name\": \"" << e._name
+          << "\", \"ph\": \"X\", \"ts\": " << e._begin << ", \"dur\": "
+          << e._dur << ", \"pid\": 1, \"tid\": " << e._tid << "}";
+   }
+   ofs << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+//----------------------------------------------------------------------
+//    Member functions of class MyTraceSpan
+//----------------------------------------------------------------------
+MyTraceSpan::MyTraceSpan(const char* name)
+   : _name(name), _begin(myTrace.isOn() ? myTrace.now() : 0)
+{
+}
+
+MyTraceSpan::~MyTraceSpan()
+{
+   if (myTrace.isOn()) myTrace.add(_name, _begin, myTrace.now());
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+  FileName     [ myTrace.h ]
+  PackageName  [ util ]
+  Synopsis     [ Scoped time spans in Chrome trace-event format ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_TRACE_H
+#define MY_TRACE_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// TRACE_SPAN(name) times the rest of the enclosing scope as one span of
+// the trace started by myTrace.start(). Spans only exist in a build with
+// CIR_TRACE defined (make TRACE=1); otherwise the macro is empty and
+// start() refuses. Spans may end on any thread.
+#ifdef CIR_TRACE
+#define TRACE_SPAN(name) MyTraceSpan _traceSpan(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+class MyTrace
+{
+public:
+   MyTrace() : _on(false), _t0(chrono::steady_clock::now()), _nThreads(0) {}
+
+   // record spans from now on and write them to fileName at exit
+   bool start(const string& fileName);
+   bool isOn() const { return _on; }
+   // microseconds since the program started
+   double now() const {
+      return chrono::duration<double, micro>(
+                chrono::steady_clock::now() - _t0).count();
+   }
+   void add(const char* name, double begin, double end);
+   // the trace file, if start() was called
+   void atExit();
+
+private:
+   struct Event
+   {
+      string     _name;
+      double     _begin;
+      double     _dur;
+      unsigned   _tid;
+   };
+
+   bool                          _on;
+   string                        _fileName;
+   chrono::steady_clock::time_point _t0;
+   vector<Event>                 _events;
+   mutex                         _mutex;
+   unsigned                      _nThreads;
+};
+
+class MyTraceSpan
+{
+public:
+   MyTraceSpan(const char* name);
+   ~MyTraceSpan();
+
+private:
+   const char*   _name;
+   double        _begin;
+
+   MyTraceSpan(const MyTraceSpan&);          // not copyable
+   MyTraceSpan& operator=(const MyTraceSpan&);
+};
+
+#endif // MY_TRACE_H
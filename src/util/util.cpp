@@ -16,6 +16,8 @@
 #include <algorithm>
 #include "rnGen.h"
 #include "myUsage.h"
+#include "myProfile.h"
+#include "myTrace.h"
 
 using namespace std;
 
@@ -25,6 +27,8 @@ using namespace std;
 
 RandomNumGen  rnGen(0);  // use random seed = 0
 MyUsage       myUsage;
+MyProfile     myProfile;
+MyTrace       myTrace;
 
 
 //----------------------------------------------------------------------
@@ -12,12 +12,17 @@
 #include <vector>
 #include "rnGen.h"
 #include "myUsage.h"
+#include "myProfile.h"
+#include "myTrace.h"
+#include "myMemStat.h"
 
 using namespace std;
 
 // Extern global variable defined in util.cpp
 extern RandomNumGen  rnGen;
 extern MyUsage       myUsage;
+extern MyProfile     myProfile;
+extern MyTrace       myTrace;
 
 // In myString.cpp
 extern int myStrNCmp(const string& s1, const string& s2, unsigned n);
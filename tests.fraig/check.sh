@@ -0,0 +1,67 @@
+#!/bin/sh
+# Runs the dofiles of this directory and compares them with their expected
+# output; run from this directory as "./check.sh ../bin/cirTest", or with
+# "make check" from the top.
+#
+#  - do.fraig, do.aig and do.flip must print their <dofile>.log, and the
+#    files that do.fraig and do.aig write must have the checksums in
+#    <dofile>.sum.
+#  - do.fraig with "cirfraig -t N" for every N in THREADS must write the
+#    same files as do.fraig, and print the same log except for the order
+#    of its "Fraig:" lines and the note on the hardware threads.
+#
+# "./check.sh ../bin/cirTest -update" rewrites the .log and .sum files.
+
+EXEC=${1:-../bin/cirTest}
+THREADS="1 2 4 8"
+fail=0
+
+run()
+{
+   "$EXEC" -f "$1" < /dev/null > "$2" 2>&1
+}
+
+sums()
+{
+   sed -n 's/^cirw .*-o \([^ ]*\).*/\1/p' "$1" | xargs cksum
+}
+
+for d in do.fraig do.aig do.flip; do
+   run $d $d.out
+   [ $d != do.flip ] && sums $d > $d.sum.out
+   if [ "$2" = "-update" ]; then
+      mv $d.out $d.log
+      [ -f $d.sum.out ] && mv $d.sum.out $d.sum
+      continue
+   fi
+   if ! diff $d.log $d.out > /dev/null; then
+      echo "$d: output differs from $d.log"; fail=1
+   elif [ -f $d.sum ] && ! diff $d.sum $d.sum.out > /dev/null; then
+      echo "$d: written files differ from $d.sum"; fail=1
+   else
+      echo "$d: ok"
+   fi
+done
+[ "$2" = "-update" ] && exit 0
+
+grep -v "^Fraig:" do.fraig.log > do.fraig.part
+for t in $THREADS; do
+   sed -e "s/^cirfraig\$/cirfraig -t $t/" \
+       -e "s/\.fraig\.aag/.fraig$t.aag/" do.fraig > do.fraig$t
+   run do.fraig$t do.fraig$t.out
+   grep -v -e "^Fraig:" -e "^Note: -Threads" do.fraig$t.out |
+      sed -e "s/^cir> cirfraig -t $t\$/cir> cirfraig/" \
+          -e "s/\.fraig$t\.aag/.fraig.aag/" > do.fraig$t.part
+   same=1
+   diff do.fraig.part do.fraig$t.part > /dev/null || same=0
+   for f in `sed -n 's/^cirw .*-o \([^ ]*\).*/\1/p' do.fraig`; do
+      cmp -s $f `echo $f | sed "s/\.fraig\.aag/.fraig$t.aag/"` || same=0
+   done
+   if [ $same = 1 ]; then
+      echo "do.fraig -t $t: ok"
+   else
+      echo "do.fraig -t $t: differs from do.fraig"; fail=1
+   fi
+done
+
+exit $fail